@@ -1,139 +1,369 @@
 #include <fstream>
+#include <memory>
+#include <numeric>
 #include <vector>
 
 #include <bwt/bwt.hpp>
+#include <bwt/bwt_parallel.hpp>
+#include <bwt/direct_bwt.hpp>
+#include <bwt/dna_occ_table.hpp>
+#include <bwt/inverse_bwt.hpp>
+#include <bwt/parallel_suffix_array.hpp>
+#include <bwt/sa_cache.hpp>
 
 #include <bwt/bwt_builders.hpp>
+#include <bwt/dispatch.hpp>
 #include <bwt/sa_accessors.hpp>
 
+#include <util/batch.hpp>
+#include <util/benchmark.hpp>
 #include <util/buffered_reader.hpp>
+#include <util/mapped_file.hpp>
+#include <util/memory.hpp>
+#include <util/packed_dna.hpp>
 #include <util/time.hpp>
+#include <util/type_dispatch.hpp>
+#include <util/work_stealing_pool.hpp>
 
-#include <divsufsort.h>
+#include <bwt/suffix_array.hpp>
 
 #include <tlx/cmdline_parser.hpp>
 
-static_assert(sizeof(index_t) == sizeof(saidx_t));
-static_assert(sizeof(char_t) == sizeof(sauchar_t));
-
 struct {
     std::string filename;
     size_t file_size;
     
+    size_t batch_size = 256;
+    size_t prefetch_distance = 32;
+    size_t threads = 0;
+    size_t sa_threads = 0;
+    bool sa_cache = false;
+    bool direct = false;
+    bool verify = false;
+    std::string sa_cache_dir;
+    bool mmap = false;
+    unsigned index_bits = 32;
+    size_t sample_rate = 0;
+    bool packed = false;
+    bool batch = false;
+    
+    Benchmark::Config benchmark;
+    
     bool dummy_sa = false;
     bool dummy_bwt = false;
 } options;
 
+// the input files in batch mode
+std::vector<BatchFile> batch_files;
+
+Benchmark benchmark;
+
+// returns the time in nanoseconds, and counts hardware events over the same region if enabled
 template<typename algorithm_t>
 uint64_t bench(algorithm_t algorithm) {
-    const auto t0 = time();
+    benchmark.counters().start();
+    const auto t0 = time_ns();
     algorithm();
-    return time() - t0;
+    const auto dt = time_ns() - t0;
+    benchmark.counters().stop();
+    return dt;
 }
 
-void print_result(std::string&& name, const size_t bwt_length, const uint64_t dt) {
-    std::cout << "RESULT algo=" << name << " input=" << options.filename << " input_size=" << options.file_size << " bwt_length=" << bwt_length << " time=" << dt << std::endl;
+// the memory used by the suffix array in bytes
+size_t sa_bytes;
+
+void print_result(std::string&& name, const size_t bwt_length, const Measurement& m, const std::string& extra = "") {
+    const std::string result = "algo=" + name + " index_bits=" + std::to_string(options.index_bits) + " sample_rate=" + std::to_string(options.sample_rate) + " sa_bytes=" + std::to_string(sa_bytes) + " input=" + options.filename + " input_size=" + std::to_string(options.file_size) + " bwt_length=" + std::to_string(bwt_length) + " time=" + std::to_string(m.median_ms()) + extra + m.counters_to_string(options.file_size);
+    std::cout << "RESULT " << result << m.to_string() << benchmark.seed_to_string() << std::endl;
+    benchmark.record(result, m);
 }
 
-int main(int argc, char** argv) {
-    tlx::CmdlineParser cp;
-    cp.add_param_string("file", options.filename, "The input file.");
-    cp.add_flag('X', "dummy_sa", options.dummy_sa, "Internal use only.");
-    cp.add_flag('Y', "dummy_bwt", options.dummy_bwt, "Internal use only.");
-    
-    if(!cp.process(argc, argv)) {
-        return -1;
+// the cache file for the suffix array of the input
+std::string sa_cache_filename() {
+    std::string name = options.filename;
+    if(!options.sa_cache_dir.empty()) {
+        const auto slash = name.rfind('/');
+        name = options.sa_cache_dir + "/" + (slash == std::string::npos ? name : name.substr(slash + 1));
     }
-    
-    // read the input file
-    std::string input;
-    {
-        std::ifstream in(options.filename);
-        BufferedReader<char_t> r(in, 1024 * 1024 * 1024);
-        while(r) { input.push_back(r.read()); }
-        options.file_size = input.size();
+    return name + ".sa" + std::to_string(options.index_bits);
+}
+
+void print_result_sa(std::string&& name, const size_t threads, const uint64_t dt, const size_t memory, const bool ok) {
+    std::cout << "RESULT algo=SA-" << name << " index_bits=" << options.index_bits << " threads=" << threads << " input=" << options.filename << " input_size=" << options.file_size << " time=" << dt << " memory=" << memory << " ok=" << (ok ? 1 : 0) << std::endl;
+}
+
+void print_result_inverse(std::string&& name, const size_t threads, const uint64_t dt_ns, const bool ok) {
+    const double throughput = throughput_mib_s(options.file_size, dt_ns);
+    std::cout << "RESULT algo=" << name << " index_bits=" << options.index_bits << " threads=" << threads << " input=" << options.filename << " input_size=" << options.file_size << " time=" << dt_ns / 1'000'000 << " time_ns=" << dt_ns << " throughput=" << throughput << " ok=" << (ok ? 1 : 0) << std::endl;
+    if(!ok) {
+        std::cerr << "verification failed for " << name << " with " << threads << " threads" << std::endl;
     }
-    
-    // construct the suffix array
-    index_t* sa;
+}
+
+// inverts the BWT sequentially and in parallel, reports the decoding throughput and checks the result against the text
+void verify(const char_t* text, const size_t n, const std::string& bwt, const std::vector<InverseBWT::Segment>& segments) {
+    OccTable occ;
     {
-        input.push_back(0); // divsufsort needs this
-        sa = new index_t[input.size()];
-        
         const auto t0 = time();
-        divsufsort((const sauchar_t*)input.data(), (saidx_t*)sa, (saidx_t)input.size());
+        occ = OccTable(bwt.data(), n, segments.back().row);
         const auto dt = time() - t0;
-        std::cout << "constructed suffix array in " << dt << " ms" << std::endl;
+        std::cout << "built occurrence table in " << dt << " ms" << std::endl;
     }
     
-    // accessor template, bwt template (TT)
+    InverseBWT inverse(occ);
+    std::vector<char_t> out(n);
+    
+    // sequential
     {
-        SuffixArrayAccessor_Inline sa_access { sa };
+        const auto dt = bench([&](){ inverse.invert(out.data()); });
+        print_result_inverse("INV", 1, dt, std::equal(out.begin(), out.end(), text));
+    }
+    
+    // parallel, run for powers of two up to the given number of threads
+    for(const size_t p : thread_counts(std::max(options.threads, size_t(1)))) {
+        std::fill(out.begin(), out.end(), 0);
+        const auto dt = bench([&](){ inverse.invert(out.data(), segments, p); });
+        print_result_inverse("INV-PAR", p, dt, std::equal(out.begin(), out.end(), text));
+    }
+}
+
+// checks a packed BWT against the reference
+bool equal(const PackedDNA& bwt, const std::string& reference) {
+    if(bwt.size() != reference.size()) return false;
+    
+    std::vector<char_t> buffer(1024 * 1024);
+    for(size_t i = 0; i < bwt.size(); i += buffer.size()) {
+        const size_t num = std::min(buffer.size(), bwt.size() - i);
+        bwt.unpack(i, num, buffer.data());
+        if(!std::equal(buffer.begin(), buffer.begin() + num, reference.begin() + i)) return false;
+    }
+    return true;
+}
+
+// adds a variant that runs TT with the accessor and builder adapters, whose implementations are determined at runtime
+template<typename index_t, typename AccessorAdapter, typename BuilderAdapter, typename SuffixArrayAccessor>
+void add_dispatched(std::string&& name, const char_t* text, const size_t n, const SuffixArrayAccessor& sa_access) {
+    auto len = std::make_shared<size_t>(0);
+    benchmark.add([text, n, &sa_access, len](){
+        SuffixArrayAccessor_Dummy<index_t> dummy_sa;
         BWTBuilder_Inline bwt;
-        const auto dt = bench([&](){ BWT_TT(input, sa_access, bwt); });
-        print_result("TT", bwt.length(), dt);
+        BWTBuilder_Dummy dummy_bwt;
+        const AccessorAdapter sa = options.dummy_sa ? AccessorAdapter(dummy_sa) : AccessorAdapter(sa_access);
+        BuilderAdapter b = options.dummy_bwt ? BuilderAdapter(dummy_bwt) : BuilderAdapter(bwt);
+        const auto dt = bench([&](){ BWT_TT(text, n, sa, b); });
+        *len = b.length();
+        return dt;
+    }, [name, len](const Measurement& m){ print_result(std::string(name), *len, m); });
+}
+
+// TT for one combination of accessor and builder, kept out of line so that the code size of each instantiation shows
+// up as a symbol of its own
+template<typename SuffixArrayAccessor, typename BWTBuilder>
+[[gnu::noinline]] uint64_t dispatched_tt(const char_t* text, const size_t n, const SuffixArrayAccessor& sa, size_t& length) {
+    BWTBuilder bwt;
+    const auto dt = bench([&](){ BWT_TT(text, n, sa, bwt); });
+    length = bwt.length();
+    return dt;
+}
+
+// adds a variant that maps the runtime configuration to the matching TT instantiation (DT)
+template<typename index_t, typename SuffixArrayAccessor>
+void add_dispatched_tt(const char_t* text, const size_t n, const SuffixArrayAccessor& sa_access) {
+    using Accessors = TypeList<SuffixArrayAccessor, SuffixArrayAccessor_Dummy<index_t>>;
+    using Builders = TypeList<BWTBuilder_Inline, BWTBuilder_Dummy>;
+    const size_t accessor = options.dummy_sa ? 1 : 0;
+    const size_t builder = options.dummy_bwt ? 1 : 0;
+    
+    auto len = std::make_shared<size_t>(0);
+    benchmark.add([text, n, &sa_access, accessor, builder, len](){
+        const SuffixArrayAccessor_Dummy<index_t> dummy_sa;
+        uint64_t dt = 0;
+        dispatch(Accessors(), accessor, Builders(), builder, [&](auto a, auto b){
+            using Accessor = typename decltype(a)::type;
+            if constexpr(std::is_same_v<Accessor, SuffixArrayAccessor>) {
+                dt = dispatched_tt<Accessor, typename decltype(b)::type>(text, n, sa_access, *len);
+            } else {
+                dt = dispatched_tt<Accessor, typename decltype(b)::type>(text, n, dummy_sa, *len);
+            }
+        });
+        return dt;
+    }, [len](const Measurement& m){ print_result("DT", *len, m); });
+}
+
+template<typename index_t, typename SuffixArrayAccessor, typename make_interface_t>
+void bench_bwt(const char_t* text, const size_t n, const SuffixArrayAccessor& sa_access, make_interface_t make_interface, const std::vector<InverseBWT::Segment>& segments) {
+    if(options.dummy_sa || options.dummy_bwt) {
+        std::cout << "you shouldn't actually use this flag, we just want to make sure that the type is determined at runtime!" << std::endl;
     }
     
-    // accessor template, bwt interface (TI)
-    {
-        SuffixArrayAccessor_Inline sa_access { sa };
-        IBWTBuilder* bwt;
-        if(options.dummy_bwt) {
-            bwt = new BWTBuilder_Dummy();
-            std::cout << "you shouldn't actually use this flag, we just want to make sure that the type is determined at runtime!" << std::endl;
-        } else {
-            bwt = new BWTBuilder_Interface();
+    // the implementations behind the interfaces are determined at runtime
+    auto make_sa = [&](){
+        return options.dummy_sa ? (ISuffixArrayAccess<index_t>*)new SuffixArrayAccessor_Dummy<index_t>() : make_interface();
+    };
+    auto make_bwt = [](){
+        return options.dummy_bwt ? (IBWTBuilder*)new BWTBuilder_Dummy() : new BWTBuilder_Interface();
+    };
+    auto make_batch_bwt = [](){
+        return options.dummy_bwt ? (IBWTBatchBuilder*)new BWTBatchBuilder_Dummy() : new BWTBatchBuilder_Interface();
+    };
+    
+    // the length of the BWT computed by each variant in its last repetition
+    size_t len_tt, len_tp, len_ti, len_it, len_ii, len_tb, len_ib;
+    
+    // the BWT computed by TT in the last round, for verification
+    std::string bwt_tt;
+    
+    // accessor template, bwt template (TT)
+    benchmark.add([&](){
+        BWTBuilder_Inline bwt;
+        const auto dt = bench([&](){ BWT_TT(text, n, sa_access, bwt); });
+        len_tt = bwt.length();
+        if((options.verify || options.packed) && benchmark.last_round()) bwt_tt = std::move(bwt.bwt);
+        return dt;
+    }, [&](const Measurement& m){
+        print_result("TT", len_tt, m);
+        if(options.verify) {
+            verify(text, n, bwt_tt, segments);
         }
-        
-        const auto dt = bench([&](){ BWT_TI(input, sa_access, bwt); });
-        print_result("TI", bwt->length(), dt);
-        
+    });
+    
+    // accessor template, bwt template, prefetching the text (TP)
+    benchmark.add([&](){
+        BWTBuilder_Inline bwt;
+        const auto dt = bench([&](){ BWT_TP(text, n, sa_access, bwt, options.prefetch_distance, options.batch_size); });
+        len_tp = bwt.length();
+        return dt;
+    }, [&](const Measurement& m){ print_result("TP", len_tp, m, " prefetch_distance=" + std::to_string(options.prefetch_distance) + " batch_size=" + std::to_string(options.batch_size)); });
+    
+    // accessor template, bwt interface (TI)
+    benchmark.add([&](){
+        IBWTBuilder* bwt = make_bwt();
+        const auto dt = bench([&](){ BWT_TI(text, n, sa_access, bwt); });
+        len_ti = bwt->length();
         delete bwt;
-    }
+        return dt;
+    }, [&](const Measurement& m){ print_result("TI", len_ti, m); });
 
     // accessor interface, bwt template (IT)
-    {
-        ISuffixArrayAccess* sa_access;
-        if(options.dummy_sa) {
-            sa_access = new SuffixArrayAccessor_Dummy();
-            std::cout << "you shouldn't actually use this flag, we just want to make sure that the type is determined at runtime!" << std::endl;
-        } else {
-            sa_access = new SuffixArrayAccessor_Interface(sa);
-        }
-        
+    benchmark.add([&](){
+        ISuffixArrayAccess<index_t>* sa_access = make_sa();
         BWTBuilder_Inline bwt;
-        
-        const auto dt = bench([&](){ BWT_IT(input, sa_access, bwt); });
-        print_result("IT", bwt.length(), dt);
-        
+        const auto dt = bench([&](){ BWT_IT(text, n, sa_access, bwt); });
+        len_it = bwt.length();
         delete sa_access;
-    }
+        return dt;
+    }, [&](const Measurement& m){ print_result("IT", len_it, m); });
 
     // accessor interface, bwt interface (II)
-    {
-        ISuffixArrayAccess* sa_access;
-        if(options.dummy_sa) {
-            sa_access = new SuffixArrayAccessor_Dummy();
-            std::cout << "you shouldn't actually use this flag, we just want to make sure that the type is determined at runtime!" << std::endl;
-        } else {
-            sa_access = new SuffixArrayAccessor_Interface(sa);
+    benchmark.add([&](){
+        ISuffixArrayAccess<index_t>* sa_access = make_sa();
+        IBWTBuilder* bwt = make_bwt();
+        const auto dt = bench([&](){ BWT_II(text, n, sa_access, bwt); });
+        len_ii = bwt->length();
+        delete sa_access;
+        delete bwt;
+        return dt;
+    }, [&](const Measurement& m){ print_result("II", len_ii, m); });
+    
+    // accessor template, batch builder interface (TB)
+    benchmark.add([&](){
+        IBWTBatchBuilder* bwt = make_batch_bwt();
+        const auto dt = bench([&](){ BWT_TB(text, n, sa_access, bwt, options.batch_size); });
+        len_tb = bwt->length();
+        delete bwt;
+        return dt;
+    }, [&](const Measurement& m){ print_result("TB", len_tb, m, " batch_size=" + std::to_string(options.batch_size)); });
+    
+    // accessor interface, batch builder interface (IB)
+    benchmark.add([&](){
+        ISuffixArrayAccess<index_t>* sa_access = make_sa();
+        IBWTBatchBuilder* bwt = make_batch_bwt();
+        const auto dt = bench([&](){ BWT_IB(text, n, sa_access, bwt, options.batch_size); });
+        len_ib = bwt->length();
+        delete sa_access;
+        delete bwt;
+        return dt;
+    }, [&](const Measurement& m){ print_result("IB", len_ib, m, " batch_size=" + std::to_string(options.batch_size)); });
+    
+    // accessor and bwt dispatched via std::variant (VAR), function pointer tables (FP), std::function (FN)
+    // and a small-buffer callable (SBO)
+    add_dispatched<index_t,
+        SuffixArrayAccessor_Variant<index_t, SuffixArrayAccessor, SuffixArrayAccessor_Dummy<index_t>>,
+        BWTBuilder_Variant<BWTBuilder_Inline, BWTBuilder_Dummy>>("VAR", text, n, sa_access);
+    add_dispatched<index_t, SuffixArrayAccessor_FunctionPointers<index_t>, BWTBuilder_FunctionPointers>("FP", text, n, sa_access);
+    add_dispatched<index_t, SuffixArrayAccessor_Function<index_t>, BWTBuilder_Function>("FN", text, n, sa_access);
+    add_dispatched<index_t, SuffixArrayAccessor_SmallFunction<index_t>, BWTBuilder_SmallFunction>("SBO", text, n, sa_access);
+    
+    // accessor and bwt template, instantiation chosen at runtime (DT)
+    add_dispatched_tt<index_t>(text, n, sa_access);
+    
+    // two bits per character for text and bwt (TT-2BIT, TI-2BIT, TB-2BIT), checked against TT
+    PackedDNA packed;
+    PackedDNA bwt_tt_2bit, bwt_ti_2bit, bwt_tb_2bit;
+    auto packed_extra = [&](const PackedDNA& bwt, const std::string& more = ""){
+        const bool ok = equal(bwt, bwt_tt);
+        if(!ok) std::cerr << "packed BWT differs from TT" << std::endl;
+        return more + " text_bytes=" + std::to_string(packed.size_bytes()) + " bwt_bytes=" + std::to_string(bwt.size_bytes()) + " ok=" + (ok ? "1" : "0");
+    };
+    
+    if(options.packed && !DNAOccTable::suitable(text, n)) {
+        std::cout << "the input is not DNA, skipping the packed rows" << std::endl;
+    } else if(options.packed) {
+        {
+            const auto t0 = time();
+            packed = PackedDNA(text, n);
+            const auto dt = time() - t0;
+            std::cout << "packed text in " << dt << " ms (" << packed.size_bytes() << " bytes, " << packed.num_exceptions() << " exceptions)" << std::endl;
         }
         
-        IBWTBuilder* bwt;
-        if(options.dummy_bwt) {
-            bwt = new BWTBuilder_Dummy();
-            std::cout << "you shouldn't actually use this flag, we just want to make sure that the type is determined at runtime!" << std::endl;
-        } else {
-            bwt = new BWTBuilder_Interface();
-        }
+        // accessor template, packed bwt template (TT-2BIT)
+        benchmark.add([&](){
+            PackedDNABWTBuilder_Inline bwt;
+            bwt.bwt.reserve(n);
+            const auto dt = bench([&](){ BWT_TT(packed, n, sa_access, bwt); });
+            bwt_tt_2bit = std::move(bwt.bwt);
+            return dt;
+        }, [&](const Measurement& m){ print_result("TT-2BIT", bwt_tt_2bit.size(), m, packed_extra(bwt_tt_2bit)); });
         
-        const auto dt = bench([&](){ BWT_II(input, sa_access, bwt); });
-        print_result("II", bwt->length(), dt);
+        // accessor template, packed bwt interface (TI-2BIT)
+        benchmark.add([&](){
+            auto* bwt = new PackedDNABWTBuilder_Interface();
+            bwt->bwt.reserve(n);
+            const auto dt = bench([&](){ BWT_TI(packed, n, sa_access, bwt); });
+            bwt_ti_2bit = std::move(bwt->bwt);
+            delete bwt;
+            return dt;
+        }, [&](const Measurement& m){ print_result("TI-2BIT", bwt_ti_2bit.size(), m, packed_extra(bwt_ti_2bit)); });
         
-        delete sa_access;
-        delete bwt;
+        // accessor template, packed batch builder interface (TB-2BIT)
+        benchmark.add([&](){
+            auto* bwt = new PackedDNABWTBatchBuilder_Interface();
+            bwt->bwt.reserve(n);
+            const auto dt = bench([&](){ BWT_TB(packed, n, sa_access, bwt, options.batch_size); });
+            bwt_tb_2bit = std::move(bwt->bwt);
+            delete bwt;
+            return dt;
+        }, [&](const Measurement& m){ print_result("TB-2BIT", bwt_tb_2bit.size(), m, packed_extra(bwt_tb_2bit, " batch_size=" + std::to_string(options.batch_size))); });
+    }
+    
+    // accessor template, random access bwt template, multi-threaded (PAR)
+    // run for powers of two up to the given number of threads
+    const auto counts = thread_counts(options.threads);
+    std::vector<size_t> len_par(counts.size());
+    for(size_t k = 0; k < counts.size(); k++) {
+        const size_t p = counts[k];
+        benchmark.add([&, k, p](){
+            BWTRandomAccessBuilder_Inline bwt;
+            const auto dt = bench([&](){ BWT_Parallel(text, n, sa_access, bwt, p); });
+            len_par[k] = bwt.length();
+            return dt;
+        }, [&, k, p](const Measurement& m){
+            print_result("PAR", len_par[k], m, " threads=" + std::to_string(p) + " throughput=" + std::to_string(throughput_mib_s(n, m)));
+        }, false);
     }
     
+    benchmark.run();
+    
     /*
     // trie template, consumer template (TT)
     {
@@ -198,6 +428,369 @@ int main(int argc, char** argv) {
     }
     */
     
-    // clean up
-    delete[] sa;
+}
+
+// compares the direct BWT construction against the suffix array based one
+template<typename index_t>
+void bench_direct(const char_t* text, const size_t n) {
+    // direct
+    BWTBuilder_Inline direct;
+    {
+        const size_t mem0 = current_memory();
+        reset_peak_memory();
+        const auto t0 = time_ns();
+        BWT_Direct<index_t>(text, n, direct);
+        const auto dt = time_ns() - t0;
+        const size_t mem = peak_memory() - mem0;
+        print_result("DIRECT", direct.length(), Measurement({ dt }), " memory=" + std::to_string(mem));
+    }
+    
+    // suffix array, then TT
+    {
+        BWTBuilder_Inline bwt;
+        const size_t mem0 = current_memory();
+        reset_peak_memory();
+        const auto t0 = time_ns();
+        {
+            index_t* sa = construct_suffix_array<index_t>(text, n);
+            BWT_TT(text, n, SuffixArrayAccessor_Inline<index_t> { sa }, bwt);
+            std::free(sa);
+        }
+        const auto dt = time_ns() - t0;
+        const size_t mem = peak_memory() - mem0;
+        
+        sa_bytes = n * sizeof(index_t);
+        const bool ok = (bwt.bwt == direct.bwt);
+        print_result("SA+TT", bwt.length(), Measurement({ dt }), " memory=" + std::to_string(mem) + " ok=" + (ok ? "1" : "0"));
+        if(!ok) {
+            std::cerr << "the direct BWT does not match the suffix array based one" << std::endl;
+        }
+    }
+}
+
+// the memory a thread of the batch mode reuses for all files it processes
+template<typename index_t>
+class BatchWorkspace {
+private:
+    void* m_sa;
+    size_t m_sa_capacity; // in bytes
+
+public:
+    BWTBuilder_Inline bwt;
+    
+    inline BatchWorkspace() : m_sa(nullptr), m_sa_capacity(0) {
+    }
+    
+    BatchWorkspace(const BatchWorkspace&) = delete;
+    BatchWorkspace& operator=(const BatchWorkspace&) = delete;
+    
+    inline ~BatchWorkspace() {
+        std::free(m_sa);
+    }
+    
+    // the memory for constructing the suffix array of a text of length n, only reallocated if it is too small
+    inline void* sa_memory(const size_t n) {
+        const size_t bytes = suffix_array_bytes<index_t>(n);
+        if(bytes > m_sa_capacity) {
+            std::free(m_sa);
+            m_sa = std::malloc(bytes);
+            m_sa_capacity = bytes;
+        }
+        return m_sa;
+    }
+};
+
+// constructs the suffix array and the BWT using TT of all files of the batch on a work-stealing pool (BATCH)
+// each thread reuses its suffix array memory and builder for all files it processes
+template<typename index_t>
+void bench_batch() {
+    // run for powers of two up to the given number of threads
+    const auto counts = thread_counts(std::max(options.threads, size_t(1)));
+    
+    // the total BWT length, steals and per-file latencies of each variant in its last repetition
+    std::vector<size_t> length(counts.size());
+    std::vector<size_t> steals(counts.size());
+    std::vector<Measurement> latencies(counts.size());
+    uint64_t time_single = 0; // the median time of a single thread, for the speedup
+    
+    for(size_t k = 0; k < counts.size(); k++) {
+        const size_t p = counts[k];
+        benchmark.add([&, k, p](){
+            WorkStealingPool pool(p);
+            std::vector<BatchWorkspace<index_t>> workspaces(p);
+            std::vector<size_t> lengths(p, 0);
+            std::vector<uint64_t> file_ns(batch_files.size());
+            
+            benchmark.counters().start();
+            const auto t0 = time_ns();
+            pool.run(batch_files.size(), [&](const size_t t, const size_t j){
+                const auto t1 = time_ns();
+                auto& ws = workspaces[t];
+                
+                // the mapping is followed by a zero, which we include as the sentinel
+                MappedFile in(batch_files[j].name, MappedFile::RANDOM);
+                if(!in) return; // the file was removed since it was scanned
+                
+                const size_t n = in.size() + 1;
+                const index_t* sa = construct_suffix_array<index_t>(in.data(), n, ws.sa_memory(n));
+                
+                ws.bwt.bwt.clear();
+                BWT_TT(in.data(), n, SuffixArrayAccessor_Inline<index_t> { sa }, ws.bwt);
+                lengths[t] += ws.bwt.length();
+                file_ns[j] = time_ns() - t1;
+            });
+            const auto dt = time_ns() - t0;
+            benchmark.counters().stop();
+            
+            length[k] = std::accumulate(lengths.begin(), lengths.end(), size_t(0));
+            steals[k] = pool.steals();
+            latencies[k] = Measurement(std::move(file_ns));
+            return dt;
+        }, [&, k, p](const Measurement& m){
+            if(p == 1) time_single = m.median();
+            const double throughput = throughput_mib_s(options.file_size, m);
+            const double speedup = m.median() ? double(time_single) / double(m.median()) : 0.0;
+            print_result("BATCH", length[k], m, " threads=" + std::to_string(p) + " files=" + std::to_string(batch_files.size()) + " throughput=" + std::to_string(throughput)
+                + latencies_to_string(latencies[k]) + " steals=" + std::to_string(steals[k]) + " speedup=" + std::to_string(speedup) + " efficiency=" + std::to_string(speedup / double(p)));
+        }, false);
+    }
+    benchmark.run();
+}
+
+template<typename index_t>
+void bench_bwt(const char_t* text, const size_t n) {
+    if(options.direct) {
+        bench_direct<index_t>(text, n);
+        return;
+    }
+    
+    // load the suffix array from the cache, if possible
+    const index_t* sa = nullptr;
+    std::unique_ptr<SuffixArrayCache<index_t>> cache;
+    if(options.sa_cache) {
+        cache = std::make_unique<SuffixArrayCache<index_t>>(sa_cache_filename());
+        
+        const auto t0 = time();
+        sa = cache->load(text, n);
+        const auto dt = time() - t0;
+        if(sa) {
+            std::cout << "loaded suffix array from " << cache->filename() << " in " << dt << " ms" << std::endl;
+        } else {
+            std::cout << "no valid suffix array cached in " << cache->filename() << std::endl;
+        }
+    }
+    
+    // construct the suffix array
+    index_t* constructed = nullptr;
+    if(!sa) {
+        const size_t mem0 = current_memory();
+        reset_peak_memory();
+        const auto t0 = time();
+        constructed = construct_suffix_array<index_t>(text, n);
+        const auto dt = time() - t0;
+        const size_t mem = peak_memory() - mem0;
+        std::cout << "constructed suffix array in " << dt << " ms" << std::endl;
+        sa = constructed;
+        
+        if(options.sa_threads > 0) {
+            print_result_sa("divsufsort", 1, dt, mem, true);
+        }
+        
+        if(cache) {
+            const auto t0 = time();
+            if(cache->store(text, n, sa)) {
+                std::cout << "stored suffix array in " << cache->filename() << " in " << (time() - t0) << " ms" << std::endl;
+            } else {
+                std::cerr << "failed to write " << cache->filename() << std::endl;
+            }
+        }
+    }
+    
+    // multi-threaded suffix array construction, verified against divsufsort
+    // run for powers of two up to the given number of threads
+    for(const size_t p : thread_counts(options.sa_threads)) {
+        const size_t mem0 = current_memory();
+        reset_peak_memory();
+        const auto t0 = time();
+        index_t* sa_par = construct_suffix_array_parallel<index_t>(text, n, p);
+        const auto dt = time() - t0;
+        const size_t mem = peak_memory() - mem0;
+        
+        bool ok = true;
+        for(size_t i = 0; i < n; i++) {
+            if(uint64_t(sa_par[i]) != uint64_t(sa[i])) {
+                ok = false;
+                break;
+            }
+        }
+        std::free(sa_par);
+        
+        print_result_sa("doubling", p, dt, mem, ok);
+        if(!ok) {
+            std::cerr << "verification failed for the parallel suffix array with " << p << " threads" << std::endl;
+        }
+    }
+    
+    // rows to start the parallel inversion from, determined while the full suffix array is available
+    std::vector<InverseBWT::Segment> segments;
+    if(options.verify) {
+        segments = InverseBWT::segments(SuffixArrayAccessor_Inline<index_t> { sa }, n, 64 * std::max(options.threads, size_t(1)));
+    }
+    
+    if(options.sample_rate > 0) {
+        // sample the suffix array and discard the full one
+        const auto t0 = time();
+        SampledSuffixArray<index_t> sampled(text, n, sa, options.sample_rate);
+        const auto dt = time() - t0;
+        std::free(constructed);
+        cache.reset();
+        
+        sa_bytes = sampled.size_bytes();
+        std::cout << "sampled suffix array in " << dt << " ms" << std::endl;
+        
+        bench_bwt<index_t>(text, n, SampledSuffixArrayAccessor_Inline<index_t> { &sampled },
+            [&](){ return new SampledSuffixArrayAccessor_Interface<index_t>(&sampled); }, segments);
+    } else {
+        sa_bytes = n * sizeof(index_t);
+        bench_bwt<index_t>(text, n, SuffixArrayAccessor_Inline<index_t> { sa },
+            [&](){ return new SuffixArrayAccessor_Interface<index_t>(sa); }, segments);
+        std::free(constructed);
+    }
+}
+
+int main(int argc, char** argv) {
+    tlx::CmdlineParser cp;
+    cp.add_param_string("file", options.filename, "The input file.");
+    cp.add_size_t('b', "batch_size", options.batch_size, "The number of characters passed to the builder at once in TP, TB and IB (default: 256).");
+    cp.add_size_t('d', "prefetch_distance", options.prefetch_distance, "The number of suffix array entries TP reads ahead to prefetch the text (default: 32).");
+    cp.add_size_t('p', "threads", options.threads, "Also run the multi-threaded construction for up to this many threads (default: 0, off).");
+    cp.add_size_t('P', "sa_threads", options.sa_threads, "Also run the multi-threaded suffix array construction for up to this many threads and verify it (default: 0, off).");
+    cp.add_flag('c', "sa_cache", options.sa_cache, "Load the suffix array from a cache file next to the input, or construct and store it if the cache is missing or stale.");
+    cp.add_string('C', "sa_cache_dir", options.sa_cache_dir, "Keep the suffix array cache files in this directory instead (implies --sa_cache).");
+    cp.add_flag('D', "direct", options.direct, "Only construct the BWT directly using divbwt and compare it against the suffix array based construction.");
+    cp.add_flag('v', "verify", options.verify, "Invert the BWT computed by TT sequentially and in parallel (using up to --threads threads) and check it against the input.");
+    cp.add_flag('m', "mmap", options.mmap, "Map the input file into memory instead of reading it into a string.");
+    cp.add_unsigned('i', "index_bits", options.index_bits, "The width of suffix array entries in bits: 32 (default), 40 or 64.");
+    cp.add_size_t('k', "sample_rate", options.sample_rate, "Sample the suffix array, keeping every k-th text position, and recover the other entries using the LF-mapping (default: 0, store the full suffix array).");
+    cp.add_flag('g', "packed", options.packed, "Also construct the BWT from a text packed into two bits per character into a packed BWT, if the input is DNA.");
+    cp.add_size_t('r', "reps", options.benchmark.reps, "The number of measured repetitions of each variant; RESULT lines report the median (default: 1).");
+    cp.add_size_t('w', "warmup", options.benchmark.warmup, "The number of unmeasured warm-up repetitions of each variant (default: 0).");
+    cp.add_flag('R', "shuffle", options.benchmark.shuffle, "Run the variants in a different random order in every repetition.");
+    cp.add_size_t('E', "shuffle_seed", options.benchmark.seed, "The seed for shuffling the variants (default: random, reported as shuffle_seed).");
+    cp.add_int('u', "pin", options.benchmark.cpu, "Pin the single-threaded variants to this CPU (default: -1, off).");
+    cp.add_flag('e', "perf", options.benchmark.perf, "Count hardware events (cycles, instructions, branch, cache and TLB misses) and report IPC and events per input character.");
+    cp.add_string('J', "json", options.benchmark.json, "Append the results to this file as JSON, one object per line.");
+    cp.add_string('V', "csv", options.benchmark.csv, "Append the results to this CSV file.");
+    cp.add_flag('l', "batch", options.batch, "Construct the BWT of every file in the directory given as the input, or listed in the input file (one per line), on a work-stealing pool using up to --threads threads.");
+    cp.add_flag('X', "dummy_sa", options.dummy_sa, "Internal use only.");
+    cp.add_flag('Y', "dummy_bwt", options.dummy_bwt, "Internal use only.");
+    
+    if(!cp.process(argc, argv)) {
+        return -1;
+    }
+    
+    if(options.batch_size == 0) {
+        std::cerr << "unsupported batch size: " << options.batch_size << std::endl;
+        return -1;
+    }
+    
+    benchmark.configure(options.benchmark);
+    
+    if(!options.sa_cache_dir.empty()) {
+        options.sa_cache = true;
+    }
+    
+    // in batch mode, the input names a directory or a list of files
+    if(options.batch) {
+        batch_files = list_batch_files(options.filename);
+        if(batch_files.empty()) {
+            std::cerr << "no input files found in " << options.filename << std::endl;
+            return -1;
+        }
+        std::cout << "batch files=" << batch_files.size() << " largest=" << batch_files.front().size << " smallest=" << batch_files.back().size << std::endl;
+        
+        // the 32-bit build of divsufsort uses signed indices
+        if(options.index_bits == 32 && batch_files.front().size + 1 > size_t(INT32_MAX)) {
+            std::cerr << "the largest file is too large for 32-bit indices, use --index_bits 40 or 64" << std::endl;
+            return -1;
+        }
+        
+        // read the files once to avoid bias
+        uint64_t chksum = 0;
+        options.file_size = 0;
+        for(const auto& file : batch_files) {
+            MappedFile in(file.name);
+            if(!in) {
+                std::cerr << "cannot open " << file.name << std::endl;
+                return -1;
+            }
+            for(size_t i = 0; i < in.size(); i++) chksum += in.data()[i];
+            options.file_size += in.size();
+        }
+        std::cout << "file chksum=" << chksum << std::endl;
+        
+        if(options.index_bits == 32) {
+            bench_batch<uint32_t>();
+        } else if(options.index_bits == 40) {
+            bench_batch<uint40_t>();
+        } else if(options.index_bits == 64) {
+            bench_batch<uint64_t>();
+        } else {
+            std::cerr << "unsupported index width: " << options.index_bits << std::endl;
+            return -1;
+        }
+        return 0;
+    }
+    
+    // read the input file
+    std::string input;
+    std::unique_ptr<MappedFile> mapped;
+    const char_t* text;
+    size_t n;
+    {
+        const auto t0 = time();
+        if(options.mmap) {
+            // the mapping is followed by a zero, which we include as the sentinel
+            mapped = std::make_unique<MappedFile>(options.filename, MappedFile::RANDOM);
+            if(!*mapped) {
+                std::cerr << "cannot open " << options.filename << std::endl;
+                return -1;
+            }
+            options.file_size = mapped->size();
+            text = mapped->data();
+        } else {
+            std::ifstream in(options.filename);
+            if(!in) {
+                std::cerr << "cannot open " << options.filename << std::endl;
+                return -1;
+            }
+            BufferedReader<char_t> r(in, 1024 * 1024 * 1024);
+            while(r) { input.push_back(r.read()); }
+            options.file_size = input.size();
+            
+            input.push_back(0); // divsufsort needs this
+            text = input.data();
+        }
+        n = options.file_size + 1;
+        
+        const auto dt = time() - t0;
+        std::cout << "read input in " << dt << " ms" << std::endl;
+    }
+    
+    // the 32-bit build of divsufsort uses signed indices
+    if(options.index_bits == 32 && n > size_t(INT32_MAX)) {
+        std::cerr << "the input is too large for 32-bit indices, use --index_bits 40 or 64" << std::endl;
+        return -1;
+    }
+    
+    if(options.index_bits == 32) {
+        bench_bwt<uint32_t>(text, n);
+    } else if(options.index_bits == 40) {
+        bench_bwt<uint40_t>(text, n);
+    } else if(options.index_bits == 64) {
+        bench_bwt<uint64_t>(text, n);
+    } else {
+        std::cerr << "unsupported index width: " << options.index_bits << std::endl;
+        return -1;
+    }
 }
@@ -1,38 +1,112 @@
 #pragma once
 
+#include <algorithm>
+#include <vector>
+
 #include "interfaces.hpp"
 
-template<typename SuffixArrayAccessor, typename BWTBuilder>
-inline static void BWT_TT(const std::string& text, const SuffixArrayAccessor& sa, BWTBuilder& bwt) {
-    const size_t n = text.size();
+// the text is either a pointer to its characters or a type with the same access operator (e.g., PackedDNA)
+template<typename Text, typename SuffixArrayAccessor, typename BWTBuilder>
+inline static void BWT_TT(const Text& text, const size_t n, const SuffixArrayAccessor& sa, BWTBuilder& bwt) {
     for(size_t i = 0; i < n; i++) {
         const auto j = sa[i];
         bwt.push_back(text[j > 0 ? j - 1 : n - 1]);
     }
 }
 
-template<typename BWTBuilder>
-inline static void BWT_IT(const std::string& text, const ISuffixArrayAccess* sa, BWTBuilder& bwt) {
-    const size_t n = text.size();
+template<typename index_t, typename BWTBuilder>
+inline static void BWT_IT(const char_t* text, const size_t n, const ISuffixArrayAccess<index_t>* sa, BWTBuilder& bwt) {
     for(size_t i = 0; i < n; i++) {
         const auto j = (*sa)[i];
         bwt.push_back(text[j > 0 ? j - 1 : n - 1]);
     }
 }
 
-template<typename SuffixArrayAccessor>
-inline static void BWT_TI(const std::string& text, const SuffixArrayAccessor& sa, IBWTBuilder* bwt) {
-    const size_t n = text.size();
+template<typename Text, typename SuffixArrayAccessor>
+inline static void BWT_TI(const Text& text, const size_t n, const SuffixArrayAccessor& sa, IBWTBuilder* bwt) {
     for(size_t i = 0; i < n; i++) {
         const auto j = sa[i];
         bwt->push_back(text[j > 0 ? j - 1 : n - 1]);
     }
 }
 
-inline static void BWT_II(const std::string& text, const ISuffixArrayAccess* sa, IBWTBuilder* bwt) {
-    const size_t n = text.size();
+template<typename index_t>
+inline static void BWT_II(const char_t* text, const size_t n, const ISuffixArrayAccess<index_t>* sa, IBWTBuilder* bwt) {
     for(size_t i = 0; i < n; i++) {
         const auto j = (*sa)[i];
         bwt->push_back(text[j > 0 ? j - 1 : n - 1]);
     }
 }
+
+// the BWT is collected in a local buffer and passed to the builder in batches
+template<typename Text, typename SuffixArrayAccessor>
+inline static void BWT_TB(const Text& text, const size_t n, const SuffixArrayAccessor& sa, IBWTBatchBuilder* bwt, const size_t batch_size) {
+    std::vector<char_t> batch(batch_size);
+    for(size_t i = 0; i < n; i += batch_size) {
+        const size_t num = std::min(batch_size, n - i);
+        for(size_t k = 0; k < num; k++) {
+            const auto j = sa[i + k];
+            batch[k] = text[j > 0 ? j - 1 : n - 1];
+        }
+        bwt->append(batch.data(), num);
+    }
+}
+
+template<typename index_t>
+inline static void BWT_IB(const char_t* text, const size_t n, const ISuffixArrayAccess<index_t>* sa, IBWTBatchBuilder* bwt, const size_t batch_size) {
+    std::vector<char_t> batch(batch_size);
+    for(size_t i = 0; i < n; i += batch_size) {
+        const size_t num = std::min(batch_size, n - i);
+        for(size_t k = 0; k < num; k++) {
+            const auto j = (*sa)[i + k];
+            batch[k] = text[j > 0 ? j - 1 : n - 1];
+        }
+        bwt->append(batch.data(), num);
+    }
+}
+
+// software pipelined variant of BWT_TT that hides the latency of the random accesses into the text
+//
+// The suffix array is read distance entries ahead of the current position and the text position it refers to is
+// prefetched, so that its cache line has arrived by the time it is needed. Each suffix array entry is read only once;
+// the positions in flight are kept in a small ring buffer. The BWT is passed to the builder in batches.
+template<typename SuffixArrayAccessor, typename BWTBuilder>
+inline static void BWT_TP(const char_t* text, const size_t n, const SuffixArrayAccessor& sa, BWTBuilder& bwt, const size_t distance, const size_t batch_size) {
+    auto source = [&](const size_t i) -> size_t {
+        const size_t j = sa[i];
+        return j > 0 ? j - 1 : n - 1;
+    };
+    
+    // at most n positions can be in flight, so a distance beyond the text does not grow the ring
+    const size_t ahead = std::min(std::max(distance, size_t(1)), n);
+    
+    // the ring size is a power of two of at least the number of positions in flight
+    size_t ring_size = 1;
+    while(ring_size < ahead) ring_size *= 2;
+    const size_t ring_mask = ring_size - 1;
+    std::vector<size_t> ring(ring_size);
+    
+    // fill the pipeline
+    for(size_t i = 0; i < ahead; i++) {
+        ring[i & ring_mask] = source(i);
+        __builtin_prefetch(text + ring[i & ring_mask]);
+    }
+    
+    std::vector<char_t> batch(batch_size);
+    for(size_t i = 0; i < n; i += batch_size) {
+        const size_t num = std::min(batch_size, n - i);
+        for(size_t k = 0; k < num; k++) {
+            const size_t p = ring[(i + k) & ring_mask];
+            
+            const size_t next = i + k + ahead;
+            if(next < n) {
+                const size_t q = source(next);
+                ring[next & ring_mask] = q;
+                __builtin_prefetch(text + q);
+            }
+            
+            batch[k] = text[p];
+        }
+        bwt.append(batch.data(), num);
+    }
+}
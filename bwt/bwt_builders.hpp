@@ -1,11 +1,14 @@
 #pragma once
 
+#include <util/packed_dna.hpp>
+
 #include "interfaces.hpp"
 
 struct BWTBuilder_Inline {
     std::string bwt;
     
     inline void push_back(const char_t c) { bwt.push_back(c); }
+    inline void append(const char_t* chars, const size_t num) { bwt.append(chars, num); }
     inline size_t length() const { return bwt.size(); }
 };
 
@@ -20,3 +23,47 @@ struct BWTBuilder_Dummy : public IBWTBuilder {
     virtual void push_back(const char_t c) override { }
     virtual size_t length() const override { return 0; }
 };
+
+struct BWTBatchBuilder_Interface : public IBWTBatchBuilder {
+    std::string bwt;
+    
+    virtual void append(const char_t* chars, const size_t num) override { bwt.append(chars, num); }
+    virtual size_t length() const override { return bwt.size(); }
+};
+
+struct BWTBatchBuilder_Dummy : public IBWTBatchBuilder {
+    virtual void append(const char_t* chars, const size_t num) override { }
+    virtual size_t length() const override { return 0; }
+};
+
+// receives the BWT in arbitrary order, positions must be set after resizing to the full length
+struct BWTRandomAccessBuilder_Inline {
+    std::string bwt;
+    
+    inline void resize(const size_t n) { bwt.resize(n); }
+    inline void set(const size_t i, const char_t c) { bwt[i] = c; }
+    inline size_t length() const { return bwt.size(); }
+};
+
+// builders that store the BWT of a DNA text using two bits per character
+struct PackedDNABWTBuilder_Inline {
+    PackedDNA bwt;
+    
+    inline void push_back(const char_t c) { bwt.push_back(c); }
+    inline void append(const char_t* chars, const size_t num) { bwt.append(chars, num); }
+    inline size_t length() const { return bwt.size(); }
+};
+
+struct PackedDNABWTBuilder_Interface final : public IBWTBuilder {
+    PackedDNA bwt;
+    
+    virtual void push_back(const char_t c) override { bwt.push_back(c); }
+    virtual size_t length() const override { return bwt.size(); }
+};
+
+struct PackedDNABWTBatchBuilder_Interface final : public IBWTBatchBuilder {
+    PackedDNA bwt;
+    
+    virtual void append(const char_t* chars, const size_t num) override { bwt.append(chars, num); }
+    virtual size_t length() const override { return bwt.size(); }
+};
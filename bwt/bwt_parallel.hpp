@@ -0,0 +1,31 @@
+#pragma once
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include "interfaces.hpp"
+
+// constructs the BWT using multiple threads
+//
+// Each BWT position only depends on the corresponding suffix array entry, so [0, n) is split into one contiguous
+// range per thread and every thread writes its own range of the preallocated builder without synchronization.
+template<typename SuffixArrayAccessor, typename BWTBuilder>
+inline static void BWT_Parallel(const char_t* text, const size_t n, const SuffixArrayAccessor& sa, BWTBuilder& bwt, const size_t num_threads) {
+    bwt.resize(n);
+    
+    const size_t p = std::max(num_threads, size_t(1));
+    const size_t range_size = (n + p - 1) / p;
+    
+    std::vector<std::thread> workers;
+    for(size_t begin = 0; begin < n; begin += range_size) {
+        const size_t end = std::min(begin + range_size, n);
+        workers.emplace_back([&, begin, end](){
+            for(size_t i = begin; i < end; i++) {
+                const auto j = sa[i];
+                bwt.set(i, text[j > 0 ? j - 1 : n - 1]);
+            }
+        });
+    }
+    for(auto& t : workers) t.join();
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <iostream>
+#include <memory>
+#include <type_traits>
+
+#include <util/typedefs.hpp>
+
+#include <divsufsort.h>
+#include <divsufsort64.h>
+
+// constructs the BWT of a text directly using libdivsufsort's divbwt, without materializing the suffix array
+//
+// The text is given as for the suffix array based construction, i.e., it ends with a zero that serves as the sentinel.
+// divbwt instead appends an implicit unique sentinel to the remaining text and omits it from its output, returning
+// its position (the primary index). The zero is reinserted at that position, so that the result equals the suffix
+// array based BWT if the text contains no other zeros.
+//
+// The builder receives the BWT via append and push_back.
+template<typename index_t, typename BWTBuilder>
+inline static void BWT_Direct(const char_t* text, const size_t n, BWTBuilder& bwt) {
+    if(n <= 1) {
+        if(n == 1) bwt.push_back(text[0]);
+        return;
+    }
+
+    const size_t m = n - 1; // without the sentinel
+    std::unique_ptr<char_t[]> u(new char_t[m]);
+
+    // the temporary suffix array is allocated by divbwt
+    int64_t primary;
+    if constexpr(std::is_same_v<index_t, uint32_t>) {
+        primary = divbwt((const sauchar_t*)text, (sauchar_t*)u.get(), nullptr, (saidx_t)m);
+    } else {
+        primary = divbwt64((const sauchar_t*)text, (sauchar_t*)u.get(), nullptr, (saidx64_t)m);
+    }
+
+    if(primary < 0) {
+        std::cerr << "divbwt failed" << std::endl;
+        return;
+    }
+
+    bwt.append(u.get(), primary);
+    bwt.push_back(text[m]);
+    bwt.append(u.get() + primary, m - primary);
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <functional>
+#include <variant>
+
+#include <util/small_function.hpp>
+#include <util/typedefs.hpp>
+
+// suffix array accessors and BWT builders whose implementation is chosen at runtime, dispatched without virtual methods
+//
+// The adapters provide the interface of the inline types, so they can be passed to BWT_TT. They refer to an accessor
+// or builder owned by the caller.
+
+// dispatch via std::visit over a std::variant of the alternatives
+template<typename index_t, typename... Accessors>
+class SuffixArrayAccessor_Variant {
+private:
+    std::variant<const Accessors*...> m_sa;
+
+public:
+    template<typename Accessor>
+    inline SuffixArrayAccessor_Variant(const Accessor& sa) : m_sa(&sa) {
+    }
+
+    inline index_t operator[](const size_t i) const {
+        return std::visit([&](const auto* sa){ return index_t((*sa)[i]); }, m_sa);
+    }
+};
+
+template<typename... Builders>
+class BWTBuilder_Variant {
+private:
+    std::variant<Builders*...> m_bwt;
+
+public:
+    template<typename Builder>
+    inline BWTBuilder_Variant(Builder& bwt) : m_bwt(&bwt) {
+    }
+
+    inline void push_back(const char_t c) {
+        std::visit([&](auto* bwt){ bwt->push_back(c); }, m_bwt);
+    }
+
+    inline size_t length() const {
+        return std::visit([](const auto* bwt){ return size_t(bwt->length()); }, m_bwt);
+    }
+};
+
+// dispatch via a table of plain function pointers per implementation
+template<typename index_t>
+class SuffixArrayAccessor_FunctionPointers {
+private:
+    struct Table {
+        index_t (*at)(const void*, size_t);
+    };
+
+    template<typename Accessor>
+    static constexpr Table TABLE = {
+        [](const void* sa, size_t i) -> index_t { return (*(const Accessor*)sa)[i]; }
+    };
+
+    const void* m_sa;
+    const Table* m_table;
+
+public:
+    template<typename Accessor>
+    inline SuffixArrayAccessor_FunctionPointers(const Accessor& sa) : m_sa(&sa), m_table(&TABLE<Accessor>) {
+    }
+
+    inline index_t operator[](const size_t i) const {
+        return m_table->at(m_sa, i);
+    }
+};
+
+class BWTBuilder_FunctionPointers {
+private:
+    struct Table {
+        void (*push_back)(void*, char_t);
+        size_t (*length)(const void*);
+    };
+
+    template<typename Builder>
+    static constexpr Table TABLE = {
+        [](void* bwt, char_t c) { ((Builder*)bwt)->push_back(c); },
+        [](const void* bwt) -> size_t { return ((const Builder*)bwt)->length(); }
+    };
+
+    void* m_bwt;
+    const Table* m_table;
+
+public:
+    template<typename Builder>
+    inline BWTBuilder_FunctionPointers(Builder& bwt) : m_bwt(&bwt), m_table(&TABLE<Builder>) {
+    }
+
+    inline void push_back(const char_t c) {
+        m_table->push_back(m_bwt, c);
+    }
+
+    inline size_t length() const {
+        return m_table->length(m_bwt);
+    }
+};
+
+// dispatch via one type-erased callable per method, e.g., std::function or SmallFunction
+template<typename index_t, template<typename> typename Function>
+class SuffixArrayAccessor_Erased {
+private:
+    Function<index_t(size_t)> m_at;
+
+public:
+    template<typename Accessor>
+    inline SuffixArrayAccessor_Erased(const Accessor& sa) {
+        const Accessor* x = &sa;
+        m_at = [x](size_t i){ return index_t((*x)[i]); };
+    }
+
+    inline index_t operator[](const size_t i) const {
+        return m_at(i);
+    }
+};
+
+template<template<typename> typename Function>
+class BWTBuilder_Erased {
+private:
+    Function<void(char_t)> m_push_back;
+    Function<size_t()> m_length;
+
+public:
+    template<typename Builder>
+    inline BWTBuilder_Erased(Builder& bwt) {
+        Builder* x = &bwt;
+        m_push_back = [x](char_t c){ x->push_back(c); };
+        m_length = [x](){ return size_t(x->length()); };
+    }
+
+    inline void push_back(const char_t c) {
+        m_push_back(c);
+    }
+
+    inline size_t length() const {
+        return m_length();
+    }
+};
+
+template<typename index_t>
+using SuffixArrayAccessor_Function = SuffixArrayAccessor_Erased<index_t, std::function>;
+
+using BWTBuilder_Function = BWTBuilder_Erased<std::function>;
+
+template<typename index_t>
+using SuffixArrayAccessor_SmallFunction = SuffixArrayAccessor_Erased<index_t, SmallFunction>;
+
+using BWTBuilder_SmallFunction = BWTBuilder_Erased<SmallFunction>;
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <vector>
+
+#include <util/typedefs.hpp>
+
+// the BWT of a DNA text with support for rank queries and LF-mapping, specialized for the alphabet A, C, G and T
+//
+// The characters are packed into two bits each. Every block of 192 characters occupies exactly one cache line: four
+// 32-bit counts relative to the enclosing superblock followed by 48 bytes of packed characters. A rank query counts
+// the matching two-bit codes in at most six words using popcount.
+//
+// All other characters (e.g., N or the sentinel) are exceptions. They are packed with the code of A and listed
+// separately. The counts of A exclude them, and blocks containing exceptions are flagged so that rank queries only
+// consult the exception list for those blocks.
+class DNAOccTable {
+private:
+    static constexpr size_t BLOCK_SIZE = 192;
+    static constexpr size_t WORDS_PER_BLOCK = BLOCK_SIZE / 32;
+    static constexpr size_t BLOCKS_PER_SUPER = size_t(1) << 22; // keeps counts within a superblock below 2^30
+
+    static constexpr uint32_t EXCEPTION_FLAG = uint32_t(1) << 31; // in counts[0]
+    static constexpr uint32_t COUNT_MASK = EXCEPTION_FLAG - 1;
+
+    static constexpr uint64_t LOW_BITS = 0x5555555555555555ULL;
+
+    struct alignas(64) Block {
+        uint32_t counts[4];
+        uint64_t words[WORDS_PER_BLOCK];
+    };
+    static_assert(sizeof(Block) == 64);
+
+    size_t m_size;
+    size_t m_primary;
+    char_t m_last;
+
+    uint64_t m_less[256];
+    uint64_t m_hist[256];
+
+    std::vector<Block> m_blocks;
+    std::vector<uint64_t> m_super; // 4 absolute counts before each superblock
+
+    // exceptions, sorted by position
+    std::vector<uint64_t> m_exception_pos;
+    std::vector<char_t> m_exception_char;
+
+    // the position lists of the individual exception characters, for rank queries
+    std::vector<std::vector<uint64_t>> m_exceptions_of;
+
+    // ACGT are distinguished by bits 1 and 2 of their ASCII codes: A=0, C=1, T=2, G=3
+    inline static uint64_t code(const char_t c) {
+        return ((uint8_t)c >> 1) & 3;
+    }
+
+    inline static bool is_dna(const char_t c) {
+        return c == 'A' || c == 'C' || c == 'G' || c == 'T';
+    }
+
+    // counts the occurrences of the code in the first num characters of a word (num <= 32)
+    inline static size_t count(const uint64_t word, const uint64_t c, const size_t num) {
+        const uint64_t x = word ^ (c * LOW_BITS);
+        uint64_t match = ~(x | (x >> 1)) & LOW_BITS;
+        if(num < 32) match &= (uint64_t(1) << (2 * num)) - 1;
+        return std::popcount(match);
+    }
+
+    // the number of exceptions in [begin, end)
+    inline size_t exceptions_in(const size_t begin, const size_t end) const {
+        const auto first = std::lower_bound(m_exception_pos.begin(), m_exception_pos.end(), begin);
+        const auto last = std::lower_bound(first, m_exception_pos.end(), end);
+        return last - first;
+    }
+
+public:
+    // whether the BWT is suitable, i.e., at most the given fraction of its characters are exceptions
+    inline static bool suitable(const char_t* bwt, const size_t n, const double max_exceptions = 0.01) {
+        size_t exceptions = 0;
+        for(size_t i = 0; i < n; i++) exceptions += !is_dna(bwt[i]);
+        return double(exceptions) <= max_exceptions * double(n);
+    }
+
+    inline DNAOccTable() : m_size(0), m_primary(0), m_last(0) {
+    }
+
+    inline DNAOccTable(const char_t* bwt, const size_t n, const size_t primary) : m_size(n), m_primary(primary), m_last(n > 0 ? bwt[primary] : 0) {
+        std::fill(m_hist, m_hist + 256, 0);
+        for(size_t i = 0; i < n; i++) ++m_hist[(uint8_t)bwt[i]];
+
+        uint64_t less = 0;
+        for(size_t x = 0; x < 256; x++) {
+            m_less[x] = less;
+            less += m_hist[x];
+        }
+
+        const size_t num_blocks = n / BLOCK_SIZE + 1;
+        m_blocks.resize(num_blocks, Block {});
+        m_super.resize((num_blocks / BLOCKS_PER_SUPER + 1) * 4, 0);
+        m_exceptions_of.resize(256);
+
+        uint64_t total[4] = {};
+        uint64_t super_base[4] = {};
+        for(size_t b = 0; b < num_blocks; b++) {
+            if(b % BLOCKS_PER_SUPER == 0) {
+                for(size_t x = 0; x < 4; x++) m_super[(b / BLOCKS_PER_SUPER) * 4 + x] = super_base[x] = total[x];
+            }
+
+            auto& block = m_blocks[b];
+            for(size_t x = 0; x < 4; x++) block.counts[x] = uint32_t(total[x] - super_base[x]);
+
+            const size_t begin = b * BLOCK_SIZE;
+            const size_t num = std::min(BLOCK_SIZE, n - std::min(begin, n));
+            for(size_t k = 0; k < num; k++) {
+                const auto c = bwt[begin + k];
+                if(is_dna(c)) {
+                    block.words[k / 32] |= code(c) << (2 * (k % 32));
+                    ++total[code(c)];
+                } else {
+                    // packed as A (zero), but not counted
+                    block.counts[0] |= EXCEPTION_FLAG;
+                    m_exception_pos.emplace_back(begin + k);
+                    m_exception_char.emplace_back(c);
+                    m_exceptions_of[(uint8_t)c].emplace_back(begin + k);
+                }
+            }
+        }
+    }
+
+    // the i-th character of the BWT
+    inline char_t operator[](const size_t i) const {
+        const auto& block = m_blocks[i / BLOCK_SIZE];
+        const size_t k = i % BLOCK_SIZE;
+        const uint64_t c = (block.words[k / 32] >> (2 * (k % 32))) & 3;
+
+        if(c == 0 && (block.counts[0] & EXCEPTION_FLAG)) {
+            const auto it = std::lower_bound(m_exception_pos.begin(), m_exception_pos.end(), i);
+            if(it != m_exception_pos.end() && *it == i) return m_exception_char[it - m_exception_pos.begin()];
+        }
+        return "ACTG"[c];
+    }
+
+    // the number of occurrences of c in the first i characters of the BWT
+    inline size_t rank(const char_t c, const size_t i) const {
+        if(!is_dna(c)) {
+            const auto& pos = m_exceptions_of[(uint8_t)c];
+            return std::lower_bound(pos.begin(), pos.end(), i) - pos.begin();
+        }
+
+        const size_t b = i / BLOCK_SIZE;
+        const auto& block = m_blocks[b];
+        const uint64_t x = code(c);
+
+        size_t r = m_super[(b / BLOCKS_PER_SUPER) * 4 + x] + (block.counts[x] & COUNT_MASK);
+        const size_t k = i % BLOCK_SIZE;
+        for(size_t w = 0; w < k / 32; w++) r += count(block.words[w], x, 32);
+        if(k % 32) r += count(block.words[k / 32], x, k % 32);
+
+        if(x == 0 && (block.counts[0] & EXCEPTION_FLAG)) {
+            r -= exceptions_in(b * BLOCK_SIZE, i);
+        }
+        return r;
+    }
+
+    // the number of characters in the BWT that are smaller than c
+    inline size_t less(const char_t c) const {
+        return m_less[(uint8_t)c];
+    }
+
+    // whether c occurs in the BWT
+    inline bool contains(const char_t c) const {
+        return m_hist[(uint8_t)c] > 0;
+    }
+
+    // the row of the suffix that starts one position before the suffix of row i (cyclically)
+    inline size_t lf(const size_t i) const {
+        const auto c = (*this)[i];
+        if(i == m_primary) {
+            // the last suffix of the text consists only of c, so it is the smallest suffix starting with c
+            return m_less[(uint8_t)c];
+        }
+
+        size_t r = rank(c, i);
+        if(c == m_last) {
+            // the primary row's occurrence of c belongs to rank 0
+            r = r - (m_primary < i ? 1 : 0) + 1;
+        }
+        return m_less[(uint8_t)c] + r;
+    }
+
+    // prefetches the block needed to access or rank position i
+    inline void prefetch(const size_t i) const {
+        __builtin_prefetch(&m_blocks[i / BLOCK_SIZE]);
+    }
+
+    inline size_t primary() const {
+        return m_primary;
+    }
+
+    inline size_t num_exceptions() const {
+        return m_exception_pos.size();
+    }
+
+    inline size_t size() const {
+        return m_size;
+    }
+
+    inline size_t size_bytes() const {
+        size_t bytes = m_blocks.capacity() * sizeof(Block) + m_super.capacity() * sizeof(uint64_t)
+            + m_exception_pos.capacity() * sizeof(uint64_t) + m_exception_char.capacity() * sizeof(char_t);
+        for(const auto& pos : m_exceptions_of) bytes += pos.capacity() * sizeof(uint64_t);
+        return bytes;
+    }
+};
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <util/typedefs.hpp>
+
+#include "occ_table.hpp"
+#include "sampled_suffix_array.hpp"
+
+// an FM-index for counting and locating the occurrences of patterns in a text
+//
+// The index consists of the BWT in an occurrence table (OccTable for general texts, DNAOccTable for DNA) and a
+// sampled suffix array for locating. The occurrences of a pattern form a range of rows, which is found by backward
+// search: one rank query per pattern character and range boundary.
+//
+// Each backward search step depends on the previous one, so a single query waits for one cache miss after the other.
+// The batch interface therefore advances many queries in lockstep and prefetches the blocks of the next step of each.
+template<typename index_t, typename Occ = OccTable>
+class FMIndex {
+public:
+    // the rows [sp, ep) whose suffixes start with the pattern
+    struct Range {
+        size_t sp, ep;
+
+        inline size_t size() const { return ep - sp; }
+    };
+
+private:
+    static constexpr size_t INTERLEAVE = 16;
+
+    SampledSuffixArray<index_t, Occ> m_sa;
+
+    // one backward search step, returns false if the range became empty
+    inline bool step(Range& r, const char_t c) const {
+        const auto& bwt = m_sa.bwt();
+        if(!bwt.contains(c)) {
+            r.sp = r.ep = 0;
+            return false;
+        }
+
+        const size_t base = bwt.less(c);
+        r.sp = base + bwt.rank(c, r.sp);
+        r.ep = base + bwt.rank(c, r.ep);
+        return r.sp < r.ep;
+    }
+
+public:
+    // builds the index from the text and its suffix array, the text must end with a unique sentinel
+    inline FMIndex(const char_t* text, const size_t n, const index_t* sa, const size_t sample_rate) : m_sa(text, n, sa, sample_rate) {
+    }
+
+    inline Range search(const char_t* pattern, const size_t m) const {
+        Range r { 0, m_sa.size() };
+        for(size_t k = m; k > 0; k--) {
+            if(!step(r, pattern[k - 1])) break;
+        }
+        return r;
+    }
+
+    inline size_t count(const char_t* pattern, const size_t m) const {
+        return search(pattern, m).size();
+    }
+
+    // appends the text positions of all occurrences of the pattern, in no particular order
+    inline void locate(const char_t* pattern, const size_t m, std::vector<size_t>& out) const {
+        const auto r = search(pattern, m);
+        for(size_t i = r.sp; i < r.ep; i++) {
+            out.emplace_back(m_sa[i]);
+        }
+    }
+
+    // searches a batch of patterns, advancing groups of queries in lockstep
+    inline void search(const std::string* patterns, const size_t num, Range* ranges) const {
+        const auto& bwt = m_sa.bwt();
+        for(size_t first = 0; first < num; first += INTERLEAVE) {
+            const size_t group = std::min(INTERLEAVE, num - first);
+
+            size_t remaining[INTERLEAVE];
+            size_t active = 0;
+            for(size_t q = 0; q < group; q++) {
+                ranges[first + q] = Range { 0, m_sa.size() };
+                remaining[q] = patterns[first + q].size();
+                if(remaining[q] > 0) ++active;
+            }
+
+            while(active > 0) {
+                for(size_t q = 0; q < group; q++) {
+                    if(remaining[q] == 0) continue;
+
+                    auto& r = ranges[first + q];
+                    const char_t c = patterns[first + q][--remaining[q]];
+                    if(!step(r, c)) remaining[q] = 0;
+
+                    if(remaining[q] > 0) {
+                        bwt.prefetch(r.sp);
+                        bwt.prefetch(r.ep);
+                    } else {
+                        --active;
+                    }
+                }
+            }
+        }
+    }
+
+    inline const SampledSuffixArray<index_t, Occ>& suffix_array() const {
+        return m_sa;
+    }
+
+    inline size_t size() const {
+        return m_sa.size();
+    }
+
+    inline size_t size_bytes() const {
+        return m_sa.size_bytes();
+    }
+};
@@ -2,6 +2,7 @@
 
 #include <util/typedefs.hpp>
 
+template<typename index_t>
 class ISuffixArrayAccess {
 public:
     virtual index_t operator[](const size_t i) const = 0;
@@ -12,3 +13,11 @@ public:
     virtual void push_back(const char_t c) = 0;
     virtual size_t length() const = 0;
 };
+
+// receives the BWT in batches to amortize the cost of virtual calls
+class IBWTBatchBuilder {
+public:
+    virtual ~IBWTBatchBuilder() = default;
+    virtual void append(const char_t* chars, const size_t num) = 0;
+    virtual size_t length() const = 0;
+};
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include <util/typedefs.hpp>
+
+#include "occ_table.hpp"
+
+// reconstructs the text from its BWT using the LF-mapping
+//
+// Starting from the row of a suffix, each LF-step yields the preceding character of the text, so the text is
+// recovered back to front. To invert in parallel, the text is divided into segments, for each of which the row of
+// the suffix starting at its end is known (sampled from the suffix array). The segments are independent.
+//
+// Every LF-step is a rank query, whose block is almost never cached. Each thread therefore walks several segments in
+// lockstep and prefetches the next block of each, so that the cache misses of the segments overlap.
+class InverseBWT {
+public:
+    struct Segment {
+        size_t begin, end; // text positions
+        size_t row;        // the row of the suffix starting at end, or the primary row if end is the text length
+    };
+
+private:
+    static constexpr size_t INTERLEAVE = 8;
+
+    const OccTable* m_bwt;
+
+    // inverts a group of at most INTERLEAVE segments in lockstep
+    inline void invert_interleaved(char_t* out, const Segment* segments, const size_t num) const {
+        size_t row[INTERLEAVE];
+        size_t pos[INTERLEAVE];
+        size_t active = 0;
+        for(size_t s = 0; s < num; s++) {
+            row[s] = segments[s].row;
+            pos[s] = segments[s].end;
+            if(pos[s] > segments[s].begin) ++active;
+        }
+
+        while(active > 0) {
+            for(size_t s = 0; s < num; s++) {
+                if(pos[s] > segments[s].begin) {
+                    out[--pos[s]] = (*m_bwt)[row[s]];
+                    row[s] = m_bwt->lf(row[s]);
+                    m_bwt->prefetch(row[s]);
+                    if(pos[s] == segments[s].begin) --active;
+                }
+            }
+        }
+    }
+
+public:
+    inline InverseBWT(const OccTable& bwt) : m_bwt(&bwt) {
+    }
+
+    // determines the rows needed to invert the text in the given number of segments of (roughly) equal length
+    template<typename SuffixArrayAccessor>
+    static std::vector<Segment> segments(const SuffixArrayAccessor& sa, const size_t n, const size_t num_segments) {
+        const size_t num = std::max(size_t(1), std::min(num_segments, n));
+        const size_t length = (n + num - 1) / num;
+
+        std::vector<Segment> segments;
+        for(size_t begin = 0; begin < n; begin += length) {
+            segments.emplace_back(Segment { begin, std::min(begin + length, n), 0 });
+        }
+
+        // segment s ends where segment s+1 begins, the last one ends at the primary row
+        for(size_t i = 0; i < n; i++) {
+            const size_t j = sa[i];
+            if(j % length == 0) {
+                const size_t s = j / length;
+                if(s > 0) segments[s - 1].row = i;
+                else segments.back().row = i;
+            }
+        }
+        return segments;
+    }
+
+    // inverts the whole text sequentially, starting from the primary row
+    inline void invert(char_t* out) const {
+        size_t row = m_bwt->primary();
+        for(size_t pos = m_bwt->size(); pos > 0; ) {
+            out[--pos] = (*m_bwt)[row];
+            row = m_bwt->lf(row);
+        }
+    }
+
+    // inverts the given segments of the text using the given number of threads
+    inline void invert(char_t* out, const std::vector<Segment>& segments, const size_t num_threads) const {
+        const size_t p = std::max(num_threads, size_t(1));
+        const size_t per_thread = (segments.size() + p - 1) / p;
+
+        std::vector<std::thread> workers;
+        for(size_t first = 0; first < segments.size(); first += per_thread) {
+            const size_t last = std::min(first + per_thread, segments.size());
+            workers.emplace_back([&, first, last](){
+                for(size_t s = first; s < last; s += INTERLEAVE) {
+                    invert_interleaved(out, segments.data() + s, std::min(INTERLEAVE, last - s));
+                }
+            });
+        }
+        for(auto& t : workers) t.join();
+    }
+};
@@ -0,0 +1,211 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#ifdef __SSE2__
+#include <immintrin.h>
+#endif
+
+#include <util/typedefs.hpp>
+
+// the BWT of a text with support for rank queries and LF-mapping
+//
+// The BWT is stored in blocks of 256 characters, each preceded by the occurrence counts of all characters of the
+// effective alphabet relative to the enclosing superblock of 2^16 characters. Counts and characters of a block are
+// interleaved, so a rank query touches one superblock entry and one block, and scans at most 255 characters.
+//
+// The BWT is expected as computed from a suffix array, i.e., the row with suffix array entry zero (the primary row)
+// holds the last character of the text. The text does not need to end with a unique sentinel.
+class OccTable {
+private:
+    static constexpr size_t BLOCK_SIZE = 256;
+    static constexpr size_t SUPER_SIZE = size_t(1) << 16;
+    static constexpr size_t BLOCKS_PER_SUPER = SUPER_SIZE / BLOCK_SIZE;
+
+    size_t m_size;
+    size_t m_primary;
+    char_t m_last;
+
+    // effective alphabet
+    size_t m_sigma;
+    uint8_t m_rank_of[256];      // rank of a character in the effective alphabet
+    uint64_t m_less[256];        // number of characters in the BWT that are smaller than a character (C array)
+
+    std::vector<uint64_t> m_super; // absolute counts before each superblock
+    size_t m_stride;               // size of a block in bytes (counts followed by characters)
+    size_t m_chars_offset;         // offset of the characters in a block
+    uint8_t* m_blocks;
+    size_t m_num_blocks;
+
+    inline const uint16_t* block_counts(const size_t b) const {
+        return (const uint16_t*)(m_blocks + b * m_stride);
+    }
+
+    inline const char_t* block_chars(const size_t b) const {
+        return (const char_t*)(m_blocks + b * m_stride + m_chars_offset);
+    }
+
+    // counts the occurrences of c in the first num characters of a block
+    inline static size_t count(const char_t* chars, const char_t c, const size_t num) {
+#ifdef __SSE2__
+        const __m128i cv = _mm_set1_epi8(c);
+        size_t cnt = 0;
+        size_t k = 0;
+        for(; k + 16 <= num; k += 16) {
+            const __m128i cmp = _mm_cmpeq_epi8(_mm_load_si128((const __m128i*)(chars + k)), cv);
+            cnt += std::popcount(unsigned(_mm_movemask_epi8(cmp)));
+        }
+        if(k < num) {
+            // blocks are padded to full size, so the load stays within bounds
+            const __m128i cmp = _mm_cmpeq_epi8(_mm_load_si128((const __m128i*)(chars + k)), cv);
+            cnt += std::popcount(unsigned(_mm_movemask_epi8(cmp)) & ((1U << (num - k)) - 1));
+        }
+        return cnt;
+#else
+        size_t cnt = 0;
+        for(size_t k = 0; k < num; k++) cnt += (chars[k] == c);
+        return cnt;
+#endif
+    }
+
+public:
+    inline OccTable() : m_size(0), m_primary(0), m_last(0), m_sigma(0), m_stride(0), m_chars_offset(0), m_blocks(nullptr), m_num_blocks(0) {
+    }
+
+    inline OccTable(const char_t* bwt, const size_t n, const size_t primary) : m_size(n), m_primary(primary), m_last(n > 0 ? bwt[primary] : 0) {
+        // determine effective alphabet and C array
+        uint64_t hist[256] = {};
+        for(size_t i = 0; i < n; i++) ++hist[(uint8_t)bwt[i]];
+
+        m_sigma = 0;
+        uint64_t less = 0;
+        for(size_t x = 0; x < 256; x++) {
+            m_rank_of[x] = hist[x] ? m_sigma++ : 0;
+            m_less[x] = less;
+            less += hist[x];
+        }
+
+        // allocate blocks, the characters are aligned to cache lines
+        m_chars_offset = ((m_sigma * sizeof(uint16_t) + 63) / 64) * 64;
+        m_stride = m_chars_offset + BLOCK_SIZE;
+        m_num_blocks = n / BLOCK_SIZE + 1;
+        m_blocks = (uint8_t*)std::aligned_alloc(64, m_num_blocks * m_stride);
+        std::memset(m_blocks, 0, m_num_blocks * m_stride);
+
+        // fill
+        m_super.resize((m_num_blocks / BLOCKS_PER_SUPER + 1) * m_sigma, 0);
+        std::vector<uint64_t> total(m_sigma, 0);
+        std::vector<uint64_t> super_base(m_sigma, 0);
+        for(size_t b = 0; b < m_num_blocks; b++) {
+            if(b % BLOCKS_PER_SUPER == 0) {
+                const size_t s = b / BLOCKS_PER_SUPER;
+                for(size_t x = 0; x < m_sigma; x++) m_super[s * m_sigma + x] = super_base[x] = total[x];
+            }
+
+            auto* counts = (uint16_t*)(m_blocks + b * m_stride);
+            for(size_t x = 0; x < m_sigma; x++) counts[x] = uint16_t(total[x] - super_base[x]);
+
+            auto* chars = (char_t*)(m_blocks + b * m_stride + m_chars_offset);
+            const size_t begin = b * BLOCK_SIZE;
+            const size_t num = std::min(BLOCK_SIZE, n - std::min(begin, n));
+            for(size_t k = 0; k < num; k++) {
+                chars[k] = bwt[begin + k];
+                ++total[m_rank_of[(uint8_t)chars[k]]];
+            }
+        }
+    }
+
+    OccTable(const OccTable&) = delete;
+    OccTable& operator=(const OccTable&) = delete;
+
+    inline OccTable(OccTable&& other) : m_blocks(nullptr) {
+        *this = std::move(other);
+    }
+
+    inline OccTable& operator=(OccTable&& other) {
+        std::swap(m_size, other.m_size);
+        std::swap(m_primary, other.m_primary);
+        std::swap(m_last, other.m_last);
+        std::swap(m_sigma, other.m_sigma);
+        std::swap(m_rank_of, other.m_rank_of);
+        std::swap(m_less, other.m_less);
+        std::swap(m_super, other.m_super);
+        std::swap(m_stride, other.m_stride);
+        std::swap(m_chars_offset, other.m_chars_offset);
+        std::swap(m_blocks, other.m_blocks);
+        std::swap(m_num_blocks, other.m_num_blocks);
+        return *this;
+    }
+
+    inline ~OccTable() {
+        std::free(m_blocks);
+    }
+
+    // the i-th character of the BWT
+    inline char_t operator[](const size_t i) const {
+        return block_chars(i / BLOCK_SIZE)[i % BLOCK_SIZE];
+    }
+
+    // the number of occurrences of c in the first i characters of the BWT
+    // c must occur in the BWT
+    inline size_t rank(const char_t c, const size_t i) const {
+        const size_t x = m_rank_of[(uint8_t)c];
+        const size_t b = i / BLOCK_SIZE;
+        return m_super[(b / BLOCKS_PER_SUPER) * m_sigma + x] + block_counts(b)[x] + count(block_chars(b), c, i % BLOCK_SIZE);
+    }
+
+    // the number of characters in the BWT that are smaller than c
+    inline size_t less(const char_t c) const {
+        return m_less[(uint8_t)c];
+    }
+
+    // whether c occurs in the BWT
+    inline bool contains(const char_t c) const {
+        return m_less[(uint8_t)c] < ((uint8_t)c < 255 ? m_less[(uint8_t)c + 1] : m_size);
+    }
+
+    // the row of the suffix that starts one position before the suffix of row i (cyclically)
+    inline size_t lf(const size_t i) const {
+        const auto c = (*this)[i];
+        if(i == m_primary) {
+            // the last suffix of the text consists only of c, so it is the smallest suffix starting with c
+            return m_less[(uint8_t)c];
+        }
+
+        size_t r = rank(c, i);
+        if(c == m_last) {
+            // the primary row's occurrence of c belongs to rank 0
+            r = r - (m_primary < i ? 1 : 0) + 1;
+        }
+        return m_less[(uint8_t)c] + r;
+    }
+
+    // prefetches the block needed to access or rank position i
+    inline void prefetch(const size_t i) const {
+        const auto* block = m_blocks + (i / BLOCK_SIZE) * m_stride;
+        __builtin_prefetch(block);
+        __builtin_prefetch(block + m_chars_offset + (i % BLOCK_SIZE));
+    }
+
+    inline size_t primary() const {
+        return m_primary;
+    }
+
+    inline size_t sigma() const {
+        return m_sigma;
+    }
+
+    inline size_t size() const {
+        return m_size;
+    }
+
+    inline size_t size_bytes() const {
+        return m_num_blocks * m_stride + m_super.capacity() * sizeof(uint64_t);
+    }
+};
@@ -0,0 +1,218 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <util/typedefs.hpp>
+
+// multi-threaded suffix array construction using prefix doubling
+//
+// The suffixes are first bucketed by their first character. In every round, the suffixes in a group with equal
+// h-prefixes are sorted by the rank of the suffix starting h positions later, which orders them by their 2h-prefixes,
+// and the group is split accordingly. The rank of a suffix is the position of its group's head in the suffix array.
+// Groups of size one are final and are skipped, so later rounds mostly touch the suffixes that are not yet sorted.
+//
+// Groups are independent, so each thread handles the groups that start in its range of the suffix array. Groups
+// that are too large to be balanced this way are sorted by all threads together. The ranks are only updated after
+// all groups have been split, so that every round sees a consistent state.
+//
+// Apart from the suffix array, this needs n entries for the ranks and n bytes to mark the group heads.
+template<typename index_t>
+class ParallelSuffixArray {
+private:
+    const char_t* m_text;
+    size_t m_n;
+    size_t m_num_threads;
+
+    index_t* m_sa;
+    std::vector<index_t> m_rank;
+    // marks the positions of the suffix array that start a group, final groups have size one and a final rank
+    static constexpr uint8_t HEAD = 1;
+    static constexpr uint8_t FINAL = 2;
+    std::vector<uint8_t> m_head;
+
+    // runs f(t, begin, end) on all threads for the t-th of equally sized ranges of [0, n)
+    template<typename range_func_t>
+    void for_ranges(const size_t n, range_func_t f) {
+        const size_t p = m_num_threads;
+        const size_t range_size = (n + p - 1) / p;
+
+        std::vector<std::thread> workers;
+        for(size_t t = 0; t < p; t++) {
+            const size_t begin = std::min(t * range_size, n);
+            const size_t end = std::min(begin + range_size, n);
+            workers.emplace_back([&, t, begin, end](){ f(t, begin, end); });
+        }
+        for(auto& w : workers) w.join();
+    }
+
+    // sorts [begin, end) using all threads: chunks are sorted independently, then merged pairwise
+    template<typename comp_t>
+    void parallel_sort(index_t* begin, index_t* end, comp_t comp) {
+        const size_t n = end - begin;
+        const size_t p = m_num_threads;
+        const size_t chunk = (n + p - 1) / p;
+
+        for_ranges(n, [&](size_t, size_t b, size_t e){ std::sort(begin + b, begin + e, comp); });
+        for(size_t width = chunk; width < n; width *= 2) {
+            std::vector<std::thread> workers;
+            for(size_t b = 0; b + width < n; b += 2 * width) {
+                const size_t mid = b + width;
+                const size_t e = std::min(b + 2 * width, n);
+                workers.emplace_back([&, b, mid, e](){ std::inplace_merge(begin + b, begin + mid, begin + e, comp); });
+            }
+            for(auto& w : workers) w.join();
+        }
+    }
+
+    // marks the heads of the subgroups of a sorted group
+    template<typename key_t>
+    void mark_heads(const size_t begin, const size_t end, key_t key) {
+        auto prev = key(m_sa[begin]);
+        for(size_t k = begin + 1; k < end; k++) {
+            const auto cur = key(m_sa[k]);
+            if(cur != prev) m_head[k] = HEAD;
+            prev = cur;
+        }
+    }
+
+    // the end of the group that starts at the given position
+    inline size_t group_end(size_t k) const {
+        ++k;
+        while(k < m_n && !m_head[k]) ++k;
+        return k;
+    }
+
+    // initial bucketing of the suffixes by their first character
+    void bucket() {
+        size_t count[256] = {};
+        for(size_t i = 0; i < m_n; i++) ++count[(uint8_t)m_text[i]];
+
+        size_t start[256];
+        size_t sum = 0;
+        for(size_t x = 0; x < 256; x++) {
+            start[x] = sum;
+            if(count[x]) m_head[sum] = (count[x] == 1) ? FINAL : HEAD;
+            sum += count[x];
+        }
+
+        for(size_t i = 0; i < m_n; i++) {
+            m_rank[i] = start[(uint8_t)m_text[i]];
+        }
+        for(size_t i = 0; i < m_n; i++) {
+            m_sa[start[(uint8_t)m_text[i]]++] = i;
+        }
+    }
+
+    // refines the groups from h-prefixes to 2h-prefixes, returns whether unsorted groups remain
+    bool round(const size_t h) {
+        const size_t n = m_n;
+        const size_t p = m_num_threads;
+        const size_t range_size = (n + p - 1) / p;
+
+        auto key = [&](const index_t i) -> uint64_t {
+            const size_t j = uint64_t(i) + h;
+            return j < n ? uint64_t(m_rank[j]) + 1 : 0; // a shorter suffix is smaller
+        };
+        auto comp = [&](const index_t a, const index_t b){ return key(a) < key(b); };
+
+        // each thread handles the groups that start in its range
+        // the first of them is determined in advance, so no thread reads into a group that another one is splitting
+        std::vector<size_t> first_head(p);
+        for(size_t t = 0; t < p; t++) {
+            size_t k = std::min(t * range_size, n);
+            while(k < n && !m_head[k]) ++k;
+            first_head[t] = k;
+        }
+
+        const size_t large = std::max(n / (4 * p), size_t(1024));
+        std::vector<std::pair<size_t, size_t>> large_groups;
+        std::mutex large_mutex;
+
+        for_ranges(n, [&](size_t t, size_t, size_t end){
+            for(size_t k = first_head[t]; k < end; ) {
+                const size_t e = group_end(k);
+                if(m_head[k] == HEAD) {
+                    if(e - k > large && p > 1) {
+                        // deferred, sorted by all threads together
+                        std::lock_guard lock(large_mutex);
+                        large_groups.emplace_back(k, e);
+                    } else {
+                        std::sort(m_sa + k, m_sa + e, comp);
+                        mark_heads(k, e, key);
+                    }
+                }
+                k = e;
+            }
+        });
+
+        for(const auto& [b, e] : large_groups) {
+            parallel_sort(m_sa + b, m_sa + e, comp);
+            mark_heads(b, e, key);
+        }
+
+        // update the ranks of the suffixes in groups that were not final
+        // the head preceding each range and whether a head follows it are determined in advance for the same reason
+        std::vector<size_t> prev_head(p);
+        std::vector<uint8_t> next_is_head(p);
+        for(size_t t = 0; t < p; t++) {
+            const size_t begin = std::min(t * range_size, n);
+            const size_t end = std::min(begin + range_size, n);
+            size_t k = begin;
+            while(k > 0 && k < n && !m_head[k]) --k;
+            prev_head[t] = k;
+            next_is_head[t] = (end == n || m_head[end]);
+        }
+
+        std::vector<uint8_t> unsorted(p, 0);
+        for_ranges(n, [&](size_t t, size_t begin, size_t end){
+            size_t head = prev_head[t];
+            for(size_t k = begin; k < end; k++) {
+                const auto v = m_head[k];
+                if(v == FINAL) continue;
+                if(v == HEAD) head = k;
+
+                m_rank[m_sa[k]] = head;
+                if(v == HEAD && (k + 1 < end ? m_head[k + 1] != 0 : next_is_head[t])) {
+                    m_head[k] = FINAL; // singleton
+                } else {
+                    unsorted[t] = 1;
+                }
+            }
+        });
+
+        return std::find(unsorted.begin(), unsorted.end(), 1) != unsorted.end();
+    }
+
+public:
+    inline ParallelSuffixArray(const char_t* text, const size_t n, const size_t num_threads)
+        : m_text(text), m_n(n), m_num_threads(std::max(num_threads, size_t(1))) {
+    }
+
+    // constructs the suffix array, which must be freed using std::free
+    index_t* construct() {
+        m_sa = (index_t*)std::malloc(m_n * sizeof(index_t));
+        if(m_n == 0) return m_sa;
+
+        m_rank.resize(m_n);
+        m_head.assign(m_n, 0);
+
+        bucket();
+        for(size_t h = 1; round(h); h *= 2) {}
+
+        m_rank = std::vector<index_t>();
+        m_head = std::vector<uint8_t>();
+        return m_sa;
+    }
+};
+
+// constructs the suffix array of the text using the given number of threads
+// the returned array must be freed using std::free
+template<typename index_t>
+index_t* construct_suffix_array_parallel(const char_t* text, const size_t n, const size_t num_threads) {
+    return ParallelSuffixArray<index_t>(text, n, num_threads).construct();
+}
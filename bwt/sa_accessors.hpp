@@ -1,20 +1,39 @@
 #pragma once
 
 #include "interfaces.hpp"
+#include "sampled_suffix_array.hpp"
 
+template<typename index_t>
 struct SuffixArrayAccessor_Inline {
     const index_t* sa;
     
     inline index_t operator[](const size_t i) const { return sa[i]; }
 };
 
-struct SuffixArrayAccessor_Interface : public ISuffixArrayAccess {
+template<typename index_t>
+struct SuffixArrayAccessor_Interface : public ISuffixArrayAccess<index_t> {
     const index_t* sa;
     
     inline SuffixArrayAccessor_Interface(const index_t* _sa) : sa(_sa) {}
     virtual index_t operator[](const size_t i) const override { return sa[i]; }
 };
 
-struct SuffixArrayAccessor_Dummy : public ISuffixArrayAccess {
+template<typename index_t>
+struct SampledSuffixArrayAccessor_Inline {
+    const SampledSuffixArray<index_t>* sa;
+    
+    inline index_t operator[](const size_t i) const { return (*sa)[i]; }
+};
+
+template<typename index_t>
+struct SampledSuffixArrayAccessor_Interface : public ISuffixArrayAccess<index_t> {
+    const SampledSuffixArray<index_t>* sa;
+    
+    inline SampledSuffixArrayAccessor_Interface(const SampledSuffixArray<index_t>* _sa) : sa(_sa) {}
+    virtual index_t operator[](const size_t i) const override { return (*sa)[i]; }
+};
+
+template<typename index_t>
+struct SuffixArrayAccessor_Dummy : public ISuffixArrayAccess<index_t> {
     virtual index_t operator[](const size_t i) const override { return 0; }
 };
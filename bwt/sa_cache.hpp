@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+
+#include <util/hash.hpp>
+#include <util/mapped_file.hpp>
+#include <util/typedefs.hpp>
+
+// a suffix array stored in a file, which is mapped into memory instead of being constructed again
+//
+// The file starts with a header that identifies the input by its size and a hash of its contents and records the
+// width of the entries. The header is padded to a full page, so the entries are page aligned in the mapping and can be
+// accessed directly. If the header does not match the input, the cache is considered stale.
+template<typename index_t>
+class SuffixArrayCache {
+private:
+    static constexpr char MAGIC[8] = { 'S', 'A', 'C', 'A', 'C', 'H', 'E', '1' };
+    static constexpr size_t HEADER_SIZE = 4096;
+
+    struct Header {
+        char magic[8];
+        uint64_t size;       // number of suffixes
+        uint64_t hash;       // hash of the text, including the sentinel
+        uint64_t index_size; // size of an entry in bytes
+    };
+
+    std::string m_filename;
+    std::unique_ptr<MappedFile> m_mapped;
+
+public:
+    inline SuffixArrayCache(const std::string& filename) : m_filename(filename) {
+    }
+
+    // maps the cached suffix array of the text into memory
+    // returns nullptr if there is no cache file or it belongs to a different input
+    inline const index_t* load(const char_t* text, const size_t n) {
+        {
+            std::ifstream probe(m_filename);
+            if(!probe) return nullptr;
+        }
+
+        auto mapped = std::make_unique<MappedFile>(m_filename, MappedFile::RANDOM);
+        if(!*mapped || mapped->size() != HEADER_SIZE + n * sizeof(index_t)) return nullptr;
+
+        Header header;
+        std::memcpy(&header, mapped->data(), sizeof(Header));
+        if(std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 ||
+           header.size != n ||
+           header.index_size != sizeof(index_t) ||
+           header.hash != hash_bytes(text, n)) {
+            return nullptr;
+        }
+
+        m_mapped = std::move(mapped);
+        return (const index_t*)(m_mapped->data() + HEADER_SIZE);
+    }
+
+    // writes the suffix array of the text into the cache file
+    // returns false if the file could not be written
+    inline bool store(const char_t* text, const size_t n, const index_t* sa) const {
+        std::ofstream out(m_filename, std::ios::binary | std::ios::trunc);
+        if(!out) return false;
+
+        char header[HEADER_SIZE] = {};
+        Header h;
+        std::memcpy(h.magic, MAGIC, sizeof(MAGIC));
+        h.size = n;
+        h.hash = hash_bytes(text, n);
+        h.index_size = sizeof(index_t);
+        std::memcpy(header, &h, sizeof(Header));
+
+        out.write(header, HEADER_SIZE);
+        out.write((const char*)sa, n * sizeof(index_t));
+        return bool(out);
+    }
+
+    inline const std::string& filename() const {
+        return m_filename;
+    }
+};
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <vector>
+
+#include <util/rank_bit_vector.hpp>
+#include <util/typedefs.hpp>
+
+#include "occ_table.hpp"
+
+// a suffix array that only stores the entries with text positions divisible by the sampling rate k
+//
+// The other entries are recovered using the LF-mapping on the BWT: if row i is not sampled, then the entry of LF(i)
+// is one less than that of row i, so at most k-1 steps lead to a sampled row. The sampled rows are marked in a bit
+// vector, whose rank gives the position of a row's entry among the samples.
+//
+// This needs n bytes for the BWT, roughly n/8 bytes for the marks and n/k entries, instead of n entries. The BWT can be
+// stored in any table that supports the LF-mapping, such as the DNAOccTable.
+template<typename index_t, typename Occ = OccTable>
+class SampledSuffixArray {
+private:
+    size_t m_rate;
+    Occ m_bwt;
+    RankBitVector m_sampled;
+    std::vector<index_t> m_samples;
+
+public:
+    // builds the sampled suffix array from the full suffix array of the text
+    inline SampledSuffixArray(const char_t* text, const size_t n, const index_t* sa, const size_t rate) : m_rate(rate < 1 ? 1 : rate), m_sampled(n) {
+        size_t primary = 0;
+        {
+            std::vector<char_t> bwt(n);
+            for(size_t i = 0; i < n; i++) {
+                const size_t j = sa[i];
+                bwt[i] = text[j > 0 ? j - 1 : n - 1];
+                if(j == 0) primary = i;
+            }
+            m_bwt = Occ(bwt.data(), n, primary);
+        }
+
+        m_samples.reserve(n / m_rate + 1);
+        for(size_t i = 0; i < n; i++) {
+            const size_t j = sa[i];
+            if(j % m_rate == 0) {
+                m_sampled.set(i);
+                m_samples.emplace_back(j);
+            }
+        }
+        m_sampled.build();
+    }
+
+    inline index_t operator[](size_t i) const {
+        size_t steps = 0;
+        while(!m_sampled[i]) {
+            i = m_bwt.lf(i);
+            ++steps;
+        }
+        return index_t(uint64_t(m_samples[m_sampled.rank1(i)]) + steps);
+    }
+
+    inline size_t sample_rate() const {
+        return m_rate;
+    }
+
+    inline const Occ& bwt() const {
+        return m_bwt;
+    }
+
+    inline size_t size() const {
+        return m_bwt.size();
+    }
+
+    inline size_t size_bytes() const {
+        return m_bwt.size_bytes() + m_sampled.size_bytes() + m_samples.capacity() * sizeof(index_t);
+    }
+};
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdlib>
+#include <type_traits>
+
+#include <util/typedefs.hpp>
+
+#include <divsufsort.h>
+#include <divsufsort64.h>
+
+// the supported index types are uint32_t for inputs up to 4 GiB, uint40_t for up to 1 TiB using five bytes per entry,
+// and uint64_t
+
+// the number of bytes construct_suffix_array needs to construct the suffix array of a text of length n in place
+// uint32_t indices use the 32-bit build of libdivsufsort, uint64_t and uint40_t indices use the 64-bit build
+template<typename index_t>
+constexpr size_t suffix_array_bytes(const size_t n) {
+    return n * (std::is_same_v<index_t, uint32_t> ? sizeof(saidx_t) : sizeof(saidx64_t));
+}
+
+// constructs the suffix array of the text using libdivsufsort in the given memory of suffix_array_bytes(n) bytes
+// and returns it, i.e., the same memory
+// for uint40_t, the 64-bit entries are packed in place afterwards, so only the first 5n bytes are used in the end
+template<typename index_t>
+index_t* construct_suffix_array(const char_t* text, const size_t n, void* memory) {
+    static_assert(sizeof(char_t) == sizeof(sauchar_t));
+
+    if constexpr(std::is_same_v<index_t, uint32_t>) {
+        static_assert(sizeof(index_t) == sizeof(saidx_t));
+        divsufsort((const sauchar_t*)text, (saidx_t*)memory, (saidx_t)n);
+    } else if constexpr(std::is_same_v<index_t, uint64_t>) {
+        static_assert(sizeof(index_t) == sizeof(saidx64_t));
+        divsufsort64((const sauchar_t*)text, (saidx64_t*)memory, (saidx64_t)n);
+    } else if constexpr(std::is_same_v<index_t, uint40_t>) {
+        auto* sa64 = (saidx64_t*)memory;
+        divsufsort64((const sauchar_t*)text, sa64, (saidx64_t)n);
+
+        // pack, entry i is written to bytes [5i, 5i+5), which have all been read already
+        auto* sa = (index_t*)memory;
+        for(size_t i = 0; i < n; i++) {
+            const uint64_t x = sa64[i];
+            sa[i] = x;
+        }
+    } else {
+        static_assert(sizeof(index_t) == 0, "unsupported index type");
+    }
+    return (index_t*)memory;
+}
+
+// constructs the suffix array of the text using libdivsufsort
+// for uint40_t, the peak memory is that of the 64-bit suffix array
+// the returned array must be freed using std::free
+template<typename index_t>
+index_t* construct_suffix_array(const char_t* text, const size_t n) {
+    auto* sa = construct_suffix_array<index_t>(text, n, std::malloc(suffix_array_bytes<index_t>(n)));
+    if constexpr(std::is_same_v<index_t, uint40_t>) {
+        sa = (index_t*)std::realloc(sa, n * sizeof(index_t));
+    }
+    return sa;
+}
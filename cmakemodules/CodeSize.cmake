@@ -0,0 +1,33 @@
+# reports the size of the functions in a binary whose names match a pattern, e.g., the TT instantiations
+# generated by the runtime-to-template dispatch
+#
+# usage: cmake -DNM=<nm> -DBINARY=<binary> -DPATTERN=<regex> -P CodeSize.cmake
+
+execute_process(
+    COMMAND "${NM}" -C -S -t d --size-sort "${BINARY}"
+    OUTPUT_VARIABLE SYMBOLS
+    RESULT_VARIABLE NM_RESULT)
+
+if(NOT ${NM_RESULT} EQUAL 0)
+    message(FATAL_ERROR "Failed to list the symbols of ${BINARY}")
+endif()
+
+get_filename_component(NAME "${BINARY}" NAME)
+set(TOTAL 0)
+set(COUNT 0)
+
+string(REGEX MATCHALL "[^\n]+" LINES "${SYMBOLS}")
+foreach(LINE ${LINES})
+    # address, size and type of code symbols, followed by the demangled name
+    if(LINE MATCHES "^[0-9]+ 0*([0-9]+) [tTwW] (.*)$")
+        set(SIZE ${CMAKE_MATCH_1})
+        set(SYMBOL "${CMAKE_MATCH_2}")
+        if(SYMBOL MATCHES "${PATTERN}")
+            message("${NAME} ${SIZE} ${SYMBOL}")
+            math(EXPR TOTAL "${TOTAL} + ${SIZE}")
+            math(EXPR COUNT "${COUNT} + 1")
+        endif()
+    endif()
+endforeach()
+
+message("RESULT binary=${NAME} pattern=${PATTERN} functions=${COUNT} code_bytes=${TOTAL}")
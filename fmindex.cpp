@@ -0,0 +1,192 @@
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <bwt/dna_occ_table.hpp>
+#include <bwt/fm_index.hpp>
+#include <bwt/occ_table.hpp>
+#include <bwt/suffix_array.hpp>
+
+#include <util/buffered_reader.hpp>
+#include <util/mapped_file.hpp>
+#include <util/time.hpp>
+
+#include <tlx/cmdline_parser.hpp>
+
+struct {
+    std::string filename;
+    size_t file_size;
+
+    size_t num_queries = 100000;
+    size_t pattern_length = 16;
+    size_t num_locate = 1000;
+    size_t sample_rate = 32;
+    size_t seed = 147;
+    unsigned index_bits = 32;
+    bool mmap = false;
+} options;
+
+// the time taken in nanoseconds, so that the rates of short runs are not quantized
+template<typename algorithm_t>
+uint64_t bench(algorithm_t algorithm) {
+    const auto t0 = time_ns();
+    algorithm();
+    return time_ns() - t0;
+}
+
+void print_result(std::string&& name, std::string&& occ, const size_t num_queries, const uint64_t dt_ns, const size_t checksum) {
+    const double queries_per_s = dt_ns ? double(num_queries) / (double(dt_ns) / 1e9) : 0.0;
+    const double ns_per_char = num_queries ? double(dt_ns) / double(num_queries * options.pattern_length) : 0.0;
+    std::cout << "RESULT algo=" << name << " occ=" << occ << " index_bits=" << options.index_bits << " sample_rate=" << options.sample_rate << " input=" << options.filename << " input_size=" << options.file_size << " queries=" << num_queries << " pattern_length=" << options.pattern_length << " time=" << dt_ns / 1000000 << " time_ns=" << dt_ns << " queries_per_s=" << queries_per_s << " ns_per_char=" << ns_per_char << " checksum=" << checksum << std::endl;
+}
+
+template<typename index_t, typename Occ>
+void bench_index(std::string&& occ, const char_t* text, const size_t n, const index_t* sa, const std::vector<std::string>& patterns) {
+    // construct
+    std::unique_ptr<FMIndex<index_t, Occ>> index;
+    {
+        const auto t0 = time();
+        index = std::make_unique<FMIndex<index_t, Occ>>(text, n, sa, options.sample_rate);
+        const auto dt = time() - t0;
+        std::cout << "RESULT algo=BUILD occ=" << occ << " index_bits=" << options.index_bits << " sample_rate=" << options.sample_rate << " input=" << options.filename << " input_size=" << options.file_size << " time=" << dt << " index_bytes=" << index->size_bytes() << std::endl;
+    }
+
+    // count, one query after the other
+    {
+        size_t checksum = 0;
+        const auto dt = bench([&](){
+            for(const auto& p : patterns) checksum += index->count(p.data(), p.size());
+        });
+        print_result("COUNT", std::string(occ), patterns.size(), dt, checksum);
+    }
+
+    // count, interleaved batches
+    {
+        std::vector<typename FMIndex<index_t, Occ>::Range> ranges(patterns.size());
+        const auto dt = bench([&](){ index->search(patterns.data(), patterns.size(), ranges.data()); });
+
+        size_t checksum = 0;
+        for(const auto& r : ranges) checksum += r.size();
+        print_result("COUNT-BATCH", std::string(occ), patterns.size(), dt, checksum);
+    }
+
+    // locate
+    {
+        const size_t num = std::min(options.num_locate, patterns.size());
+        std::vector<size_t> occurrences;
+        const auto dt = bench([&](){
+            for(size_t q = 0; q < num; q++) index->locate(patterns[q].data(), patterns[q].size(), occurrences);
+        });
+
+        size_t checksum = 0;
+        for(const auto pos : occurrences) checksum += pos;
+        print_result("LOCATE", std::string(occ), num, dt, checksum);
+    }
+}
+
+template<typename index_t>
+void bench_fmindex(const char_t* text, const size_t n) {
+    // construct the suffix array
+    index_t* sa;
+    {
+        const auto t0 = time();
+        sa = construct_suffix_array<index_t>(text, n);
+        const auto dt = time() - t0;
+        std::cout << "constructed suffix array in " << dt << " ms" << std::endl;
+    }
+
+    // draw the patterns from the text, so that each occurs at least once
+    std::vector<std::string> patterns;
+    if(options.file_size >= options.pattern_length) {
+        std::mt19937_64 gen(options.seed);
+        std::uniform_int_distribution<size_t> dist(0, options.file_size - options.pattern_length);
+        patterns.reserve(options.num_queries);
+        for(size_t q = 0; q < options.num_queries; q++) {
+            patterns.emplace_back(text + dist(gen), options.pattern_length);
+        }
+    }
+
+    bench_index<index_t, OccTable>("byte", text, n, sa, patterns);
+    if(DNAOccTable::suitable(text, n)) {
+        bench_index<index_t, DNAOccTable>("dna", text, n, sa, patterns);
+    }
+
+    std::free(sa);
+}
+
+int main(int argc, char** argv) {
+    tlx::CmdlineParser cp;
+    cp.add_param_string("file", options.filename, "The input file.");
+    cp.add_size_t('q', "queries", options.num_queries, "The number of patterns to search (default: 100000).");
+    cp.add_size_t('l', "pattern_length", options.pattern_length, "The length of the patterns, which are drawn from the input (default: 16).");
+    cp.add_size_t('L', "locate", options.num_locate, "The number of patterns to locate (default: 1000).");
+    cp.add_size_t('k', "sample_rate", options.sample_rate, "The suffix array sampling rate used for locating (default: 32).");
+    cp.add_size_t('s', "seed", options.seed, "The seed for drawing the patterns.");
+    cp.add_unsigned('i', "index_bits", options.index_bits, "The width of suffix array entries in bits: 32 (default), 40 or 64.");
+    cp.add_flag('m', "mmap", options.mmap, "Map the input file into memory instead of reading it into a string.");
+
+    if(!cp.process(argc, argv)) {
+        return -1;
+    }
+
+    // read the input file
+    std::string input;
+    std::unique_ptr<MappedFile> mapped;
+    const char_t* text;
+    size_t n;
+    {
+        const auto t0 = time();
+        if(options.mmap) {
+            // the mapping is followed by a zero, which we include as the sentinel
+            mapped = std::make_unique<MappedFile>(options.filename, MappedFile::RANDOM);
+            if(!*mapped) {
+                std::cerr << "cannot open " << options.filename << std::endl;
+                return -1;
+            }
+            options.file_size = mapped->size();
+            text = mapped->data();
+        } else {
+            std::ifstream in(options.filename);
+            if(!in) {
+                std::cerr << "cannot open " << options.filename << std::endl;
+                return -1;
+            }
+            BufferedReader<char_t> r(in, 1024 * 1024 * 1024);
+            while(r) { input.push_back(r.read()); }
+            options.file_size = input.size();
+
+            input.push_back(0); // sentinel
+            text = input.data();
+        }
+        n = options.file_size + 1;
+
+        const auto dt = time() - t0;
+        std::cout << "read input in " << dt << " ms" << std::endl;
+    }
+
+    // the index relies on the sentinel being the unique smallest character
+    if(std::memchr(text, 0, options.file_size)) {
+        std::cerr << "the input contains zero bytes, which are reserved for the sentinel" << std::endl;
+        return -1;
+    }
+
+    // the 32-bit build of divsufsort uses signed indices
+    if(options.index_bits == 32 && n > size_t(INT32_MAX)) {
+        std::cerr << "the input is too large for 32-bit indices, use --index_bits 40 or 64" << std::endl;
+        return -1;
+    }
+
+    if(options.index_bits == 32) {
+        bench_fmindex<uint32_t>(text, n);
+    } else if(options.index_bits == 40) {
+        bench_fmindex<uint40_t>(text, n);
+    } else if(options.index_bits == 64) {
+        bench_fmindex<uint64_t>(text, n);
+    } else {
+        std::cerr << "unsupported index width: " << options.index_bits << std::endl;
+        return -1;
+    }
+}
@@ -1,47 +1,580 @@
+#include <algorithm>
+#include <cstring>
+#include <numeric>
 #include <fstream>
+#include <memory>
 #include <vector>
 
+#include <lz78/lz78_ib.hpp>
 #include <lz78/lz78_ii.hpp>
 #include <lz78/lz78_it.hpp>
+#include <lz78/lz78_parallel.hpp>
+#include <lz78/lz78_tb.hpp>
 #include <lz78/lz78_ti.hpp>
 #include <lz78/lz78_tt.hpp>
 
+#include <lz78/art_trie.hpp>
 #include <lz78/consumers.hpp>
+#include <lz78/decoder.hpp>
+#include <lz78/dense_trie.hpp>
+#include <lz78/dispatch.hpp>
+#include <lz78/factor_reader.hpp>
+#include <lz78/hash_trie.hpp>
 #include <lz78/tries.hpp>
 
+#include <util/async_reader.hpp>
+#include <util/batch.hpp>
+#include <util/benchmark.hpp>
 #include <util/buffered_reader.hpp>
+#include <util/mapped_file.hpp>
 #include <util/time.hpp>
+#include <util/type_dispatch.hpp>
+#include <util/work_stealing_pool.hpp>
 
 #include <tlx/cmdline_parser.hpp>
 
 struct {
     std::string filename;
     size_t file_size;
+    size_t sigma = 256; // the number of distinct characters in the input, measured unless reading the standard input
+    
+    std::string trie = "binary";
+    
+    size_t batch_size = 256;
+    size_t threads = 0;
+    size_t seed = 0;
+    
+    bool mmap = false;
+    bool async = false;
+    size_t async_buffers = 4;
+    size_t async_bufsize = 16 * 1024 * 1024;
+    bool verify = false;
+    std::string output;
+    bool batch = false;
+    
+    unsigned index_bits = 32;
+    
+    Benchmark::Config benchmark;
     
     bool dummy_trie = false;
     bool dummy_consumer = false;
 } options;
 
+// I/O statistics of the last run using the asynchronous reader
+struct {
+    uint64_t io_ns;
+    uint64_t wait_ns;
+    
+    std::string to_string() const {
+        const uint64_t hidden = io_ns > wait_ns ? io_ns - wait_ns : 0;
+        return " io_time=" + std::to_string(io_ns / 1'000'000) + " io_wait=" + std::to_string(wait_ns / 1'000'000) + " io_hidden=" + std::to_string(hidden / 1'000'000);
+    }
+} async_stats;
+
+// the input files in batch mode
+std::vector<BatchFile> batch_files;
+
+Benchmark benchmark;
+
+// returns the time in nanoseconds, and counts hardware events over the same region if enabled
+template<typename ctor_t, typename compress_t, typename post_t>
+uint64_t measure(ctor_t ctor, compress_t compress, post_t post) {
+    auto& counters = benchmark.counters();
+    counters.start();
+    const auto t0 = time_ns();
+    uint64_t dt_post;
+    {
+        auto c = ctor();
+        compress(c);
+        
+        // inspect the compressor, not included in the measurement
+        counters.stop();
+        const auto t1 = time_ns();
+        post(c);
+        dt_post = time_ns() - t1;
+        counters.resume();
+    }
+    const auto dt = time_ns() - t0 - dt_post;
+    counters.stop();
+    return dt;
+}
+
+template<typename ctor_t, typename post_t>
+uint64_t bench(ctor_t ctor, post_t post) {
+    if(options.mmap) {
+        MappedFile input(options.filename);
+        return measure(ctor, [&](auto& c){ c.compress(input.data(), input.size()); }, post);
+    } else if(options.async) {
+        std::ifstream input(options.filename);
+        AsyncReader<char_t> r(input, options.async_bufsize, options.async_buffers);
+        const auto dt = measure(ctor, [&](auto& c){ c.compress(r); }, post);
+        async_stats.io_ns = r.io_time_ns();
+        async_stats.wait_ns = r.wait_time_ns();
+        return dt;
+    } else {
+        std::ifstream input(options.filename);
+        return measure(ctor, [&](auto& c){ c.compress(input); }, post);
+    }
+}
+
 template<typename ctor_t>
 uint64_t bench(ctor_t ctor) {
-    std::ifstream input(options.filename);
-    {
-        const auto t0 = time();
-        {
-            auto c = ctor();
-            c.compress(input);
+    return bench(ctor, [](auto&){});
+}
+
+void print_result(std::string&& name, const size_t num_factors, const Measurement& m, const std::string& extra = "") {
+    const std::string result = "algo=" + name + " trie=" + options.trie + " index_bits=" + std::to_string(options.index_bits) + " input=" + options.filename + " input_size=" + std::to_string(options.file_size) + ", num_factors=" + std::to_string(num_factors) + " time=" + std::to_string(m.median_ms()) + extra + (options.async ? async_stats.to_string() : "") + m.counters_to_string(options.file_size);
+    std::cout << "RESULT " << result << m.to_string() << benchmark.seed_to_string() << std::endl;
+    benchmark.record(result, m);
+}
+
+// the throughput in MiB/s at the median time
+void print_result_parallel(const size_t threads, const size_t num_factors, const Measurement& m) {
+    const std::string result = "algo=PAR trie=" + options.trie + " index_bits=" + std::to_string(options.index_bits) + " threads=" + std::to_string(threads) + " seed=" + std::to_string(options.seed) + " input=" + options.filename + " input_size=" + std::to_string(options.file_size) + ", num_factors=" + std::to_string(num_factors) + " time=" + std::to_string(m.median_ms()) + " throughput=" + std::to_string(throughput_mib_s(options.file_size, m)) + m.counters_to_string(options.file_size);
+    std::cout << "RESULT " << result << m.to_string() << benchmark.seed_to_string() << std::endl;
+    benchmark.record(result, m);
+}
+
+void print_result_batch(const size_t threads, const size_t num_factors, const Measurement& m, const Measurement& latencies, const size_t steals, const uint64_t time_single) {
+    const double speedup = m.median() ? double(time_single) / double(m.median()) : 0.0;
+    const std::string result = "algo=BATCH trie=" + options.trie + " index_bits=" + std::to_string(options.index_bits) + " threads=" + std::to_string(threads) + " files=" + std::to_string(batch_files.size()) + " input=" + options.filename + " input_size=" + std::to_string(options.file_size) + ", num_factors=" + std::to_string(num_factors) + " time=" + std::to_string(m.median_ms()) + " throughput=" + std::to_string(throughput_mib_s(options.file_size, m)) + latencies_to_string(latencies) + " steals=" + std::to_string(steals) + " speedup=" + std::to_string(speedup) + " efficiency=" + std::to_string(speedup / double(threads)) + m.counters_to_string(options.file_size);
+    std::cout << "RESULT " << result << m.to_string() << benchmark.seed_to_string() << std::endl;
+    benchmark.record(result, m);
+}
+
+std::string load_input() {
+    std::string input;
+    std::ifstream in(options.filename);
+    BufferedReader<char_t> r(in, 1024 * 1024 * 1024);
+    while(r) { input.push_back(r.read()); }
+    return input;
+}
+
+// decodes the given factor blocks, reports decoding throughput and checks the result against the input
+template<typename index_t>
+void verify(std::string&& name, const std::vector<const LZ78Consumer_Inline<index_t>*>& blocks) {
+    const auto input = load_input();
+    
+    LZ78Decoder<index_t> decoder;
+    const auto t0 = time_ns();
+    for(const auto* factors : blocks) {
+        decoder.decode(factors->refs.data(), factors->chars.data(), factors->num_factors());
+    }
+    const auto dt_ns = time_ns() - t0;
+    decoder.truncate(input.size());
+    
+    const bool ok = decoder.size() == input.size() && std::memcmp(decoder.data(), input.data(), input.size()) == 0;
+    const double throughput = throughput_mib_s(decoder.size(), dt_ns);
+    std::cout << "RESULT algo=" << name << "-decode trie=" << options.trie << " index_bits=" << options.index_bits << " input=" << options.filename << " input_size=" << options.file_size << ", num_factors=" << decoder.num_factors() << " time=" << dt_ns / 1'000'000 << " time_ns=" << dt_ns << " throughput=" << throughput << " ok=" << (ok ? 1 : 0) << std::endl;
+    if(!ok) {
+        std::cerr << "verification failed for " << name << std::endl;
+    }
+}
+
+template<typename Trie>
+void print_stats(std::string&& name, const Trie& trie) {
+    if constexpr(requires { trie.print_stats(std::cout); }) {
+        std::cout << "STATS algo=" << name << " trie=" << options.trie << " nodes=" << trie.size() << " ";
+        trie.print_stats(std::cout);
+        std::cout << std::endl;
+    }
+}
+
+template<typename Trie_Inline>
+void bench_parallel() {
+    using index_t = typename Trie_Inline::index_type;
+    
+    // load the input into memory
+    std::unique_ptr<MappedFile> mapped;
+    std::string loaded;
+    const char_t* text;
+    size_t n;
+    if(options.mmap) {
+        mapped = std::make_unique<MappedFile>(options.filename);
+        text = mapped->data();
+        n = mapped->size();
+    } else {
+        loaded = load_input();
+        text = loaded.data();
+        n = loaded.size();
+    }
+    
+    // run for powers of two up to the given number of threads
+    const auto counts = thread_counts(options.threads);
+    
+    // the number of factors of each variant, and its compressor of the last round for verification
+    std::vector<size_t> num_factors(counts.size());
+    std::vector<std::unique_ptr<LZ78_Parallel<Trie_Inline>>> last(counts.size());
+    
+    for(size_t k = 0; k < counts.size(); k++) {
+        const size_t p = counts[k];
+        benchmark.add([&, k, p](){
+            auto c = std::make_unique<LZ78_Parallel<Trie_Inline>>(p, options.seed);
+            benchmark.counters().start();
+            const auto t0 = time_ns();
+            c->compress(text, n);
+            const auto dt = time_ns() - t0;
+            benchmark.counters().stop();
+            num_factors[k] = c->num_factors();
+            if(options.verify && benchmark.last_round()) last[k] = std::move(c);
+            return dt;
+        }, [&, k, p](const Measurement& m){
+            print_result_parallel(p, num_factors[k], m);
+            
+            if(options.verify) {
+                std::vector<const LZ78Consumer_Inline<index_t>*> blocks;
+                for(const auto& block : last[k]->blocks()) blocks.emplace_back(&block.factors);
+                verify("PAR", blocks);
+                last[k].reset();
+            }
+        }, false);
+    }
+    benchmark.run();
+}
+
+// compresses all files of the batch using TT on a work-stealing pool (BATCH)
+// each thread reuses its compressor, i.e., its trie, and its consumer for all files it processes
+template<typename Trie_Inline>
+void bench_batch() {
+    using index_t = typename Trie_Inline::index_type;
+    using Consumer = LZ78Consumer_Inline<index_t>;
+    using Compressor = LZ78_TT<Trie_Inline, Consumer>;
+    
+    // run for powers of two up to the given number of threads
+    const auto counts = thread_counts(std::max(options.threads, size_t(1)));
+    
+    // the number of factors, steals and per-file latencies of each variant in its last repetition
+    std::vector<size_t> num_factors(counts.size());
+    std::vector<size_t> steals(counts.size());
+    std::vector<Measurement> latencies(counts.size());
+    uint64_t time_single = 0; // the median time of a single thread, for the speedup
+    
+    for(size_t k = 0; k < counts.size(); k++) {
+        const size_t p = counts[k];
+        benchmark.add([&, k, p](){
+            WorkStealingPool pool(p);
+            std::vector<Consumer> consumers(p);
+            std::vector<std::unique_ptr<Compressor>> compressors;
+            for(auto& consumer : consumers) compressors.emplace_back(std::make_unique<Compressor>(consumer));
+            std::vector<size_t> factors(p, 0);
+            std::vector<uint64_t> file_ns(batch_files.size());
+            
+            benchmark.counters().start();
+            const auto t0 = time_ns();
+            pool.run(batch_files.size(), [&](const size_t t, const size_t j){
+                const auto t1 = time_ns();
+                MappedFile in(batch_files[j].name);
+                if(!in) return; // the file was removed since it was scanned
+                
+                compressors[t]->reset();
+                consumers[t].clear();
+                compressors[t]->compress(in.data(), in.size());
+                factors[t] += consumers[t].num_factors();
+                file_ns[j] = time_ns() - t1;
+            });
+            const auto dt = time_ns() - t0;
+            benchmark.counters().stop();
+            
+            num_factors[k] = std::accumulate(factors.begin(), factors.end(), size_t(0));
+            steals[k] = pool.steals();
+            latencies[k] = Measurement(std::move(file_ns));
+            return dt;
+        }, [&, k, p](const Measurement& m){
+            if(p == 1) time_single = m.median();
+            print_result_batch(p, num_factors[k], m, latencies[k], steals[k], time_single);
+        }, false);
+    }
+    benchmark.run();
+}
+
+// compresses the standard input, which can only be read once
+template<typename Trie_Inline>
+void bench_stdin() {
+    using index_t = typename Trie_Inline::index_type;
+    
+    LZ78Consumer_Inline<index_t> consumer;
+    AsyncReader<char_t> r(std::cin, options.async_bufsize, options.async_buffers);
+    const auto dt = measure(
+        [&](){ return LZ78_TT<Trie_Inline, decltype(consumer)>(consumer); },
+        [&](auto& c){ c.compress(r); },
+        [&](auto& c){ print_stats("TT", c.trie()); });
+    
+    options.file_size = r.items_read();
+    async_stats.io_ns = r.io_time_ns();
+    async_stats.wait_ns = r.wait_time_ns();
+    print_result("TT", consumer.num_factors(), Measurement({ dt }));
+}
+
+// adds a variant that runs TT with the trie and consumer adapters, whose implementations are determined at runtime
+template<typename Trie_Inline, typename TrieAdapter, typename ConsumerAdapter>
+void add_dispatched(std::string&& name) {
+    using index_t = typename Trie_Inline::index_type;
+    
+    auto num_factors = std::make_shared<size_t>(0);
+    benchmark.add([num_factors](){
+        LZ78Consumer_Inline<index_t> consumer;
+        LZ78Consumer_Dummy<index_t> dummy_consumer;
+        ConsumerAdapter c = options.dummy_consumer ? ConsumerAdapter(dummy_consumer) : ConsumerAdapter(consumer);
+        const auto dt = bench([&](){
+            return LZ78_TT<TrieAdapter, ConsumerAdapter>(options.dummy_trie ? TrieAdapter(LZ78Trie_Dummy<index_t>()) : TrieAdapter(Trie_Inline()), c);
+        });
+        *num_factors = c.num_factors();
+        return dt;
+    }, [name, num_factors](const Measurement& m){ print_result(std::string(name), *num_factors, m); });
+}
+
+// the tries and consumers that the dispatched TT row (DT) chooses from at runtime
+template<typename index_t>
+using DispatchTries = TypeList<BinaryTrie_Inline<index_t>, ChunkedBinaryTrie_Inline<index_t>, HashTrie_Inline<index_t>, ARTTrie_Inline<index_t>,
+    DenseTrie_Inline<index_t, 4>, DenseTrie_Inline<index_t, 8>, DenseTrie_Inline<index_t, 16>, LZ78Trie_Dummy<index_t>>;
+
+template<typename index_t>
+using DispatchConsumers = TypeList<LZ78Consumer_Inline<index_t>, LZ78Consumer_Dummy<index_t>>;
+
+// TT for one combination of trie and consumer, kept out of line so that the code size of each instantiation shows
+// up as a symbol of its own
+template<typename Trie, typename Consumer>
+[[gnu::noinline]] uint64_t dispatched_tt(size_t& num_factors) {
+    Consumer consumer;
+    const auto dt = bench([&](){ return LZ78_TT<Trie, Consumer>(consumer); });
+    num_factors = consumer.num_factors();
+    return dt;
+}
+
+// adds a variant that maps the runtime configuration to the matching TT instantiation (DT)
+template<typename index_t>
+void add_dispatched_tt() {
+    // the names of the tries in DispatchTries, which ends with the dummy
+    const std::initializer_list<std::string_view> names = { "binary", "chunked", "hash", "art", "dense4", "dense8", "dense16" };
+    size_t trie = index_of(names, options.trie);
+    if(options.dummy_trie) {
+        trie = DispatchTries<index_t>::size - 1;
+    } else if(trie >= names.size()) {
+        std::cerr << "no DT instantiation for trie " << options.trie << std::endl;
+        return;
+    }
+    const size_t consumer = options.dummy_consumer ? 1 : 0;
+    
+    auto num_factors = std::make_shared<size_t>(0);
+    benchmark.add([trie, consumer, num_factors](){
+        uint64_t dt = 0;
+        dispatch(DispatchTries<index_t>(), trie, DispatchConsumers<index_t>(), consumer, [&](auto t, auto c){
+            dt = dispatched_tt<typename decltype(t)::type, typename decltype(c)::type>(*num_factors);
+        });
+        return dt;
+    }, [num_factors](const Measurement& m){ print_result("DT", *num_factors, m); });
+}
+
+template<typename Trie_Inline, typename Trie_Interface>
+void bench_matrix() {
+    using index_t = typename Trie_Inline::index_type;
+    
+    if(options.filename == "-") {
+        bench_stdin<Trie_Inline>();
+        return;
+    }
+    
+    if(options.batch) {
+        bench_batch<Trie_Inline>();
+        return;
+    }
+    
+    if(options.dummy_trie || options.dummy_consumer) {
+        std::cout << "you shouldn't actually use this flag, we just want to make sure that the type is determined at runtime!" << std::endl;
+    }
+    
+    // the implementations behind the interfaces are determined at runtime
+    auto make_trie = [](){
+        return options.dummy_trie ? (ILZ78Trie<index_t>*)new LZ78Trie_Dummy<index_t>() : new Trie_Interface();
+    };
+    auto make_consumer = [](){
+        return options.dummy_consumer ? (ILZ78Consumer<index_t>*)new LZ78Consumer_Dummy<index_t>() : new LZ78Consumer_Interface<index_t>();
+    };
+    auto make_batch_consumer = [](){
+        return options.dummy_consumer ? (ILZ78BatchConsumer<index_t>*)new LZ78BatchConsumer_Dummy<index_t>() : new LZ78BatchConsumer_Interface<index_t>();
+    };
+    
+    // the number of factors found by each variant in its last repetition
+    size_t num_tt, num_ti, num_it, num_ii, num_tb, num_ib;
+    
+    // the factors found by TT in the last round, for verification
+    LZ78Consumer_Inline<index_t> factors_tt;
+    
+    // trie template, consumer template (TT)
+    benchmark.add([&](){
+        LZ78Consumer_Inline<index_t> consumer;
+        const auto dt = bench(
+            [&](){ return LZ78_TT<Trie_Inline, decltype(consumer)>(consumer); },
+            [&](auto& c){ if(benchmark.last_round()) print_stats("TT", c.trie()); });
+        num_tt = consumer.num_factors();
+        if(options.verify && benchmark.last_round()) factors_tt = std::move(consumer);
+        return dt;
+    }, [&](const Measurement& m){
+        print_result("TT", num_tt, m);
+        if(options.verify) {
+            verify("TT", std::vector<const LZ78Consumer_Inline<index_t>*> { &factors_tt });
+            factors_tt = LZ78Consumer_Inline<index_t>();
         }
-        return time() - t0;
+    });
+
+    // trie template, consumer interface (TI)
+    benchmark.add([&](){
+        ILZ78Consumer<index_t>* consumer = make_consumer();
+        const auto dt = bench([&](){ return LZ78_TI<Trie_Inline>(consumer); });
+        num_ti = consumer->num_factors();
+        delete consumer;
+        return dt;
+    }, [&](const Measurement& m){ print_result("TI", num_ti, m); });
+    
+    // trie interface, consumer template (IT)
+    benchmark.add([&](){
+        LZ78Consumer_Inline<index_t> consumer;
+        ILZ78Trie<index_t>* trie = make_trie();
+        const auto dt = bench([&](){ return LZ78_IT<index_t, decltype(consumer)>(trie, consumer); });
+        num_it = consumer.num_factors();
+        delete trie;
+        return dt;
+    }, [&](const Measurement& m){ print_result("IT", num_it, m); });
+
+    // trie interface, consumer interface (II)
+    benchmark.add([&](){
+        ILZ78Consumer<index_t>* consumer = make_consumer();
+        ILZ78Trie<index_t>* trie = make_trie();
+        const auto dt = bench([&](){ return LZ78_II<index_t>(trie, consumer); });
+        num_ii = consumer->num_factors();
+        delete consumer;
+        delete trie;
+        return dt;
+    }, [&](const Measurement& m){ print_result("II", num_ii, m); });
+    
+    // trie template, batch consumer interface (TB)
+    benchmark.add([&](){
+        ILZ78BatchConsumer<index_t>* consumer = make_batch_consumer();
+        const auto dt = bench([&](){ return LZ78_TB<Trie_Inline>(consumer, options.batch_size); });
+        num_tb = consumer->num_factors();
+        delete consumer;
+        return dt;
+    }, [&](const Measurement& m){ print_result("TB", num_tb, m, " batch_size=" + std::to_string(options.batch_size)); });
+    
+    // trie interface, batch consumer interface (IB)
+    benchmark.add([&](){
+        ILZ78BatchConsumer<index_t>* consumer = make_batch_consumer();
+        ILZ78Trie<index_t>* trie = make_trie();
+        const auto dt = bench([&](){ return LZ78_IB<index_t>(trie, consumer, options.batch_size); });
+        num_ib = consumer->num_factors();
+        delete consumer;
+        delete trie;
+        return dt;
+    }, [&](const Measurement& m){ print_result("IB", num_ib, m, " batch_size=" + std::to_string(options.batch_size)); });
+    
+    // trie and consumer dispatched via std::variant (VAR), function pointer tables (FP), std::function (FN)
+    // and a small-buffer callable (SBO)
+    add_dispatched<Trie_Inline,
+        LZ78Trie_Variant<index_t, Trie_Inline, LZ78Trie_Dummy<index_t>>,
+        LZ78Consumer_Variant<index_t, LZ78Consumer_Inline<index_t>, LZ78Consumer_Dummy<index_t>>>("VAR");
+    add_dispatched<Trie_Inline, LZ78Trie_FunctionPointers<index_t>, LZ78Consumer_FunctionPointers<index_t>>("FP");
+    add_dispatched<Trie_Inline, LZ78Trie_Function<index_t>, LZ78Consumer_Function<index_t>>("FN");
+    add_dispatched<Trie_Inline, LZ78Trie_SmallFunction<index_t>, LZ78Consumer_SmallFunction<index_t>>("SBO");
+    
+    // trie and consumer template, instantiation chosen at runtime (DT)
+    add_dispatched_tt<index_t>();
+    
+    // trie template, streaming consumer template, writing to the output file
+    size_t num_write, compressed_size;
+    if(!options.output.empty()) benchmark.add([&](){
+        std::ofstream out(options.output, std::ios::binary);
+        LZ78Consumer_Stream_Inline<index_t> consumer(out);
+        auto dt = bench([&](){ return LZ78_TT<Trie_Inline, decltype(consumer)>(consumer); });
+        
+        const auto t0 = time_ns();
+        consumer.finish();
+        dt += time_ns() - t0;
+        
+        num_write = consumer.num_factors();
+        compressed_size = consumer.bytes_written();
+        return dt;
+    }, [&](const Measurement& m){
+        const double throughput = throughput_mib_s(options.file_size, m);
+        const double bits_per_factor = num_write ? double(8 * compressed_size) / double(num_write) : 0.0;
+        print_result("TT-write", num_write, m, " throughput=" + std::to_string(throughput) + " output=" + options.output + " compressed_size=" + std::to_string(compressed_size) + " bits_per_factor=" + std::to_string(bits_per_factor));
+        
+        if(options.verify) {
+            LZ78Consumer_Inline<index_t> factors;
+            {
+                std::ifstream in(options.output, std::ios::binary);
+                LZ78FactorReader<index_t> reader(in);
+                index_t ref;
+                char_t c;
+                while(reader.read(ref, c)) factors.consume(ref, c);
+            }
+            verify("TT-write", std::vector<const LZ78Consumer_Inline<index_t>*> { &factors });
+        }
+    });
+    
+    benchmark.run();
+    
+    // block-parallel (PAR)
+    if(options.threads > 0) {
+        bench_parallel<Trie_Inline>();
     }
 }
 
-void print_result(std::string&& name, const size_t num_factors, const uint64_t dt) {
-    std::cout << "RESULT algo=" << name << " input=" << options.filename << " input_size=" << options.file_size << ", num_factors=" << num_factors << " time=" << dt << std::endl;
+template<typename index_t>
+int bench_tries() {
+    if(options.trie == "binary") {
+        bench_matrix<BinaryTrie_Inline<index_t>, BinaryTrie_Interface<index_t>>();
+    } else if(options.trie == "chunked") {
+        bench_matrix<ChunkedBinaryTrie_Inline<index_t>, ChunkedBinaryTrie_Interface<index_t>>();
+    } else if(options.trie == "hash") {
+        bench_matrix<HashTrie_Inline<index_t>, HashTrie_Interface<index_t>>();
+    } else if(options.trie == "art") {
+        bench_matrix<ARTTrie_Inline<index_t>, ARTTrie_Interface<index_t>>();
+    } else if(options.trie == "dense") {
+        // pick the smallest child array that fits the alphabet
+        if(options.sigma <= 4) {
+            options.trie = "dense4";
+            bench_matrix<DenseTrie_Inline<index_t, 4>, DenseTrie_Interface<index_t, 4>>();
+        } else if(options.sigma <= 8) {
+            options.trie = "dense8";
+            bench_matrix<DenseTrie_Inline<index_t, 8>, DenseTrie_Interface<index_t, 8>>();
+        } else if(options.sigma <= 16) {
+            options.trie = "dense16";
+            bench_matrix<DenseTrie_Inline<index_t, 16>, DenseTrie_Interface<index_t, 16>>();
+        } else {
+            std::cout << "the alphabet is too large for a dense trie (sigma=" << options.sigma << "), using the binary trie" << std::endl;
+            options.trie = "binary";
+            bench_matrix<BinaryTrie_Inline<index_t>, BinaryTrie_Interface<index_t>>();
+        }
+    } else {
+        std::cerr << "unknown trie: " << options.trie << std::endl;
+        return -1;
+    }
+    return 0;
 }
 
 int main(int argc, char** argv) {
     tlx::CmdlineParser cp;
-    cp.add_param_string("file", options.filename, "The input file.");
+    cp.add_param_string("file", options.filename, "The input file, or - to compress the standard input using TT only.");
+    cp.add_string('t', "trie", options.trie, "The LZ78 trie implementation: binary (default), chunked, hash, art or dense (child arrays for alphabets of up to 16 characters, falls back to binary).");
+    cp.add_size_t('b', "batch_size", options.batch_size, "The number of factors passed to the consumer at once in TB and IB (default: 256).");
+    cp.add_size_t('p', "threads", options.threads, "Also run the block-parallel factorization for up to this many threads (default: 0, off).");
+    cp.add_size_t('s', "seed", options.seed, "The length of the prefix factorized before the parallel phase to seed the tries of all threads (default: 0).");
+    cp.add_flag('m', "mmap", options.mmap, "Map the input file into memory instead of reading it through a stream.");
+    cp.add_flag('a', "async", options.async, "Read the input using a background thread (always used for the standard input).");
+    cp.add_size_t('B', "async_buffers", options.async_buffers, "The number of buffers used for asynchronous reading (default: 4).");
+    cp.add_size_t('S', "async_bufsize", options.async_bufsize, "The size of each buffer used for asynchronous reading (default: 16Mi).");
+    cp.add_flag('v', "verify", options.verify, "Decode the factorizations and check them against the input.");
+    cp.add_string('o', "output", options.output, "Also compress into this file using the bit-packed streaming consumer.");
+    cp.add_unsigned('i', "index_bits", options.index_bits, "The width of factor ids and trie nodes in bits: 32 (default), 40 or 64.");
+    cp.add_size_t('r', "reps", options.benchmark.reps, "The number of measured repetitions of each variant; RESULT lines report the median (default: 1).");
+    cp.add_size_t('w', "warmup", options.benchmark.warmup, "The number of unmeasured warm-up repetitions of each variant (default: 0).");
+    cp.add_flag('R', "shuffle", options.benchmark.shuffle, "Run the variants in a different random order in every repetition.");
+    cp.add_size_t('E', "shuffle_seed", options.benchmark.seed, "The seed for shuffling the variants (default: random, reported as shuffle_seed).");
+    cp.add_int('u', "pin", options.benchmark.cpu, "Pin the single-threaded variants to this CPU (default: -1, off).");
+    cp.add_flag('e', "perf", options.benchmark.perf, "Count hardware events (cycles, instructions, branch, cache and TLB misses) and report IPC and events per input character.");
+    cp.add_string('J', "json", options.benchmark.json, "Append the results to this file as JSON, one object per line.");
+    cp.add_string('V', "csv", options.benchmark.csv, "Append the results to this CSV file.");
+    cp.add_flag('l', "batch", options.batch, "Compress all files in the directory given as the input, or listed in the input file (one per line), on a work-stealing pool using up to --threads threads.");
     cp.add_flag('X', "dummy_trie", options.dummy_trie, "Internal use only.");
     cp.add_flag('Y', "dummy_consumer", options.dummy_consumer, "Internal use only.");
     
@@ -49,75 +582,78 @@ int main(int argc, char** argv) {
         return -1;
     }
     
-    // read the input file once to avoid bias
-    {
-        std::ifstream in(options.filename);
-        BufferedReader<char_t> r(in, 1024 * 1024 * 1024);
-        uint64_t chksum = 0;
-        options.file_size = 0;
-        while(r) { chksum += r.read(); ++options.file_size; }
-        std::cout << "file chksum=" << chksum << std::endl;
+    if(options.batch_size == 0) {
+        std::cerr << "unsupported batch size: " << options.batch_size << std::endl;
+        return -1;
     }
     
-    // trie template, consumer template (TT)
-    {
-        LZ78Consumer_Inline consumer;
-        const auto dt = bench([&](){ return LZ78_TT<BinaryTrie_Inline, decltype(consumer)>(consumer); });
-        print_result("TT", consumer.num_factors(), dt);
+    benchmark.configure(options.benchmark);
+    
+    // the standard input is read asynchronously and only once
+    if(options.filename == "-") {
+        std::ios::sync_with_stdio(false);
+        options.async = true;
     }
-
-    // trie template, consumer interface (TI)
-    {
-        ILZ78Consumer* consumer;
-        if(options.dummy_consumer) {
-            consumer = new LZ78Consumer_Dummy();
-            std::cout << "you shouldn't actually use this flag, we just want to make sure that the type is determined at runtime!" << std::endl;
-        } else {
-            consumer = new LZ78Consumer_Interface();
+    
+    // in batch mode, the input names a directory or a list of files
+    if(options.batch) {
+        if(options.filename == "-") {
+            std::cerr << "the standard input cannot be used in batch mode" << std::endl;
+            return -1;
         }
         
-        const auto dt = bench([&](){ return LZ78_TI<BinaryTrie_Inline>(consumer); });
-        print_result("TI", consumer->num_factors(), dt);
-        delete consumer;
+        batch_files = list_batch_files(options.filename);
+        if(batch_files.empty()) {
+            std::cerr << "no input files found in " << options.filename << std::endl;
+            return -1;
+        }
+        std::cout << "batch files=" << batch_files.size() << " largest=" << batch_files.front().size << " smallest=" << batch_files.back().size << std::endl;
     }
     
-    // trie interface, consumer template (IT)
-    {
-        LZ78Consumer_Inline consumer;
-        ILZ78Trie* trie;
-        if(options.dummy_trie) {
-            trie = new LZ78Trie_Dummy();
-            std::cout << "you shouldn't actually use this flag, we just want to make sure that the type is determined at runtime!" << std::endl;
-        } else {
-            trie = new BinaryTrie_Interface();
+    // read the input files once to avoid bias, and measure their alphabet
+    if(options.filename != "-") {
+        uint64_t chksum = 0;
+        uint64_t hist[256] = {};
+        options.file_size = 0;
+        auto scan = [&](const std::string& filename){
+            if(options.mmap || options.batch) {
+                MappedFile in(filename);
+                if(!in) {
+                    std::cerr << "cannot open " << filename << std::endl;
+                    return false;
+                }
+                for(size_t i = 0; i < in.size(); i++) { chksum += in.data()[i]; ++hist[(uint8_t)in.data()[i]]; }
+                options.file_size += in.size();
+            } else {
+                std::ifstream in(filename);
+                if(!in) {
+                    std::cerr << "cannot open " << filename << std::endl;
+                    return false;
+                }
+                BufferedReader<char_t> r(in, 1024 * 1024 * 1024);
+                while(r) { const auto c = r.read(); chksum += c; ++hist[(uint8_t)c]; ++options.file_size; }
+            }
+            return true;
+        };
+        if(options.batch) {
+            for(const auto& file : batch_files) {
+                if(!scan(file.name)) return -1;
+            }
+        } else if(!scan(options.filename)) {
+            return -1;
         }
-        
-        const auto dt = bench([&](){ return LZ78_IT<decltype(consumer)>(trie, consumer); });
-        print_result("IT", consumer.num_factors(), dt);
-        delete trie;
+        options.sigma = std::count_if(hist, hist + 256, [](const uint64_t x){ return x > 0; });
+        std::cout << "file chksum=" << chksum << " sigma=" << options.sigma << std::endl;
     }
-
-    // trie interface, consumer interface (II)
-    {
-        ILZ78Consumer* consumer;
-        if(options.dummy_consumer) {
-            consumer = new LZ78Consumer_Dummy();
-            std::cout << "you shouldn't actually use this flag, we just want to make sure that the type is determined at runtime!" << std::endl;
-        } else {
-            consumer = new LZ78Consumer_Interface();
-        }
-        
-        ILZ78Trie* trie;
-        if(options.dummy_trie) {
-            trie = new LZ78Trie_Dummy();
-            std::cout << "you shouldn't actually use this flag, we just want to make sure that the type is determined at runtime!" << std::endl;
-        } else {
-            trie = new BinaryTrie_Interface();
-        }
-        
-        const auto dt = bench([&](){ return LZ78_II(trie, consumer); });
-        print_result("II", consumer->num_factors(), dt);
-        delete consumer;
-        delete trie;
+    
+    if(options.index_bits == 32) {
+        return bench_tries<uint32_t>();
+    } else if(options.index_bits == 40) {
+        return bench_tries<uint40_t>();
+    } else if(options.index_bits == 64) {
+        return bench_tries<uint64_t>();
+    } else {
+        std::cerr << "unsupported index width: " << options.index_bits << std::endl;
+        return -1;
     }
 }
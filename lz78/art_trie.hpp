@@ -0,0 +1,307 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+
+#ifdef __SSE2__
+#include <immintrin.h>
+#endif
+
+#include <util/typedefs.hpp>
+
+#include "interfaces.hpp"
+
+// LZ78 trie with adaptive radix tree (ART) style nodes
+//
+// The children of a node are stored in one of four node types with capacity 4, 16, 48 or 256, and a node is moved
+// into the next larger type when it runs full. Nodes without children (i.e., most nodes in an LZ78 trie) occupy
+// no child storage at all. In 16-nodes, a child is found using a single SSE compare over all keys.
+template<typename index_t>
+class ARTTrie_Inline {
+public:
+    using index_type = index_t;
+
+private:
+    static constexpr index_t ROOT = 0;
+
+    enum NodeType : uint8_t {
+        LEAF = 0,
+        NODE4,
+        NODE16,
+        NODE48,
+        NODE256
+    };
+
+    struct Node4 {
+        uint8_t count;
+        char_t keys[4];
+        index_t children[4];
+    };
+
+    struct Node16 {
+        alignas(16) char_t keys[16];
+        index_t children[16];
+        uint8_t count;
+    };
+
+    struct Node48 {
+        uint8_t index[256]; // 1 + position in children, or 0 if there is no child for the character
+        index_t children[48];
+        uint8_t count;
+    };
+
+    struct Node256 {
+        index_t children[256];
+    };
+
+    // node pool that recycles the slots of nodes that have been moved into a larger type
+    template<typename node_t>
+    class Pool {
+    private:
+        std::vector<node_t> m_nodes;
+        std::vector<index_t> m_free;
+
+    public:
+        inline node_t& operator[](const index_t i) { return m_nodes[i]; }
+        inline const node_t& operator[](const index_t i) const { return m_nodes[i]; }
+
+        inline index_t allocate() {
+            if(!m_free.empty()) {
+                const auto i = m_free.back();
+                m_free.pop_back();
+                m_nodes[i] = node_t {};
+                return i;
+            } else {
+                m_nodes.emplace_back();
+                return (index_t)(m_nodes.size() - 1);
+            }
+        }
+
+        inline void release(const index_t i) {
+            m_free.emplace_back(i);
+        }
+
+        inline void clear() {
+            m_nodes.clear();
+            m_free.clear();
+        }
+
+        inline size_t size() const {
+            return m_nodes.size() - m_free.size();
+        }
+
+        inline size_t size_bytes() const {
+            return m_nodes.capacity() * sizeof(node_t) + m_free.capacity() * sizeof(index_t);
+        }
+    };
+
+    std::vector<NodeType> m_type;
+    std::vector<index_t> m_slot; // position in the pool of the node's type
+
+    Pool<Node4> m_node4;
+    Pool<Node16> m_node16;
+    Pool<Node48> m_node48;
+    Pool<Node256> m_node256;
+
+    inline static index_t find16(const Node16& node, const char_t c) {
+#ifdef __SSE2__
+        const __m128i keys = _mm_load_si128((const __m128i*)node.keys);
+        const __m128i cmp = _mm_cmpeq_epi8(keys, _mm_set1_epi8(c));
+        const unsigned mask = unsigned(_mm_movemask_epi8(cmp)) & ((1U << node.count) - 1);
+        return mask ? node.children[__builtin_ctz(mask)] : ROOT;
+#else
+        for(size_t i = 0; i < node.count; i++) {
+            if(node.keys[i] == c) return node.children[i];
+        }
+        return ROOT;
+#endif
+    }
+
+    inline void add_child(const index_t parent, const char_t c, const index_t child) {
+        const uint8_t uc = (uint8_t)c;
+        auto& slot = m_slot[parent];
+
+        switch(m_type[parent]) {
+            case LEAF: {
+                slot = m_node4.allocate();
+                m_type[parent] = NODE4;
+                [[fallthrough]];
+            }
+
+            case NODE4: {
+                auto& node = m_node4[slot];
+                if(node.count < 4) {
+                    node.keys[node.count] = c;
+                    node.children[node.count] = child;
+                    ++node.count;
+                    return;
+                }
+
+                // grow to 16
+                const auto grown = m_node16.allocate();
+                auto& node16 = m_node16[grown];
+                for(size_t i = 0; i < 4; i++) {
+                    node16.keys[i] = node.keys[i];
+                    node16.children[i] = node.children[i];
+                }
+                node16.count = 4;
+                m_node4.release(slot);
+                slot = grown;
+                m_type[parent] = NODE16;
+                [[fallthrough]];
+            }
+
+            case NODE16: {
+                auto& node = m_node16[slot];
+                if(node.count < 16) {
+                    node.keys[node.count] = c;
+                    node.children[node.count] = child;
+                    ++node.count;
+                    return;
+                }
+
+                // grow to 48
+                const auto grown = m_node48.allocate();
+                auto& node48 = m_node48[grown];
+                for(size_t i = 0; i < 16; i++) {
+                    node48.index[(uint8_t)node.keys[i]] = i + 1;
+                    node48.children[i] = node.children[i];
+                }
+                node48.count = 16;
+                m_node16.release(slot);
+                slot = grown;
+                m_type[parent] = NODE48;
+                [[fallthrough]];
+            }
+
+            case NODE48: {
+                auto& node = m_node48[slot];
+                if(node.count < 48) {
+                    node.children[node.count] = child;
+                    ++node.count;
+                    node.index[uc] = node.count;
+                    return;
+                }
+
+                // grow to 256
+                const auto grown = m_node256.allocate();
+                auto& node256 = m_node256[grown];
+                for(size_t x = 0; x < 256; x++) {
+                    if(node.index[x]) node256.children[x] = node.children[node.index[x] - 1];
+                }
+                m_node48.release(slot);
+                slot = grown;
+                m_type[parent] = NODE256;
+                [[fallthrough]];
+            }
+
+            case NODE256: {
+                m_node256[slot].children[uc] = child;
+                return;
+            }
+        }
+    }
+
+public:
+    inline ARTTrie_Inline() {
+        m_type.reserve(16);
+        m_slot.reserve(16);
+
+        // node 0 is the root
+        m_type.emplace_back(LEAF);
+        m_slot.emplace_back(0);
+    }
+
+    // removes all nodes but the root, keeping the allocated memory for reuse
+    inline void clear() {
+        m_type.clear();
+        m_slot.clear();
+        m_node4.clear();
+        m_node16.clear();
+        m_node48.clear();
+        m_node256.clear();
+
+        m_type.emplace_back(LEAF);
+        m_slot.emplace_back(0);
+    }
+
+    inline index_t root() const {
+        return ROOT;
+    }
+
+    inline size_t size() const {
+        return m_type.size();
+    }
+
+    inline index_t get_child(const index_t node, const char_t c) {
+        const auto slot = m_slot[node];
+        switch(m_type[node]) {
+            case NODE4: {
+                const auto& n = m_node4[slot];
+                for(size_t i = 0; i < n.count; i++) {
+                    if(n.keys[i] == c) return n.children[i];
+                }
+                return ROOT;
+            }
+
+            case NODE16:
+                return find16(m_node16[slot], c);
+
+            case NODE48: {
+                const auto& n = m_node48[slot];
+                const auto i = n.index[(uint8_t)c];
+                return i ? n.children[i - 1] : ROOT;
+            }
+
+            case NODE256:
+                return m_node256[slot].children[(uint8_t)c];
+
+            default:
+                return ROOT;
+        }
+    }
+
+    inline index_t insert_child(const index_t parent, const char_t c) {
+        const index_t new_child = (index_t)size();
+        m_type.emplace_back(LEAF);
+        m_slot.emplace_back(0);
+        add_child(parent, c, new_child);
+        return new_child;
+    }
+
+    inline void print_stats(std::ostream& out) const {
+        out << "leaves=" << (size() - m_node4.size() - m_node16.size() - m_node48.size() - m_node256.size())
+            << " node4=" << m_node4.size()
+            << " node16=" << m_node16.size()
+            << " node48=" << m_node48.size()
+            << " node256=" << m_node256.size()
+            << " bytes=" << (m_type.capacity() * sizeof(NodeType) + m_slot.capacity() * sizeof(index_t)
+                            + m_node4.size_bytes() + m_node16.size_bytes() + m_node48.size_bytes() + m_node256.size_bytes());
+    }
+};
+
+template<typename index_t>
+class ARTTrie_Interface : public ILZ78Trie<index_t> {
+public:
+    using index_type = index_t;
+
+private:
+    ARTTrie_Inline<index_t> m_trie;
+
+public:
+    virtual index_t root() const override {
+        return m_trie.root();
+    }
+
+    virtual size_t size() const override {
+        return m_trie.size();
+    }
+
+    virtual index_t get_child(const index_t node, const char_t c) override {
+        return m_trie.get_child(node, c);
+    }
+
+    virtual index_t insert_child(const index_t parent, const char_t c) override {
+        return m_trie.insert_child(parent, c);
+    }
+};
@@ -1,7 +1,12 @@
 #pragma once
 
+#include <bit>
+#include <vector>
+
 #include "interfaces.hpp"
+#include <util/bit_writer.hpp>
 
+template<typename index_t>
 struct LZ78Consumer_Inline {
     std::vector<index_t> refs;
     std::vector<char_t> chars;
@@ -14,9 +19,16 @@ struct LZ78Consumer_Inline {
     inline size_t num_factors() const {
         return refs.size();
     }
+    
+    // removes all factors, keeping the allocated memory for reuse
+    inline void clear() {
+        refs.clear();
+        chars.clear();
+    }
 };
 
-struct LZ78Consumer_Interface : public ILZ78Consumer {
+template<typename index_t>
+struct LZ78Consumer_Interface : public ILZ78Consumer<index_t> {
     std::vector<index_t> refs;
     std::vector<char_t> chars;
     
@@ -30,7 +42,86 @@ struct LZ78Consumer_Interface : public ILZ78Consumer {
     }
 };
 
-struct LZ78Consumer_Dummy : public ILZ78Consumer {
+template<typename index_t>
+struct LZ78BatchConsumer_Interface : public ILZ78BatchConsumer<index_t> {
+    std::vector<index_t> refs;
+    std::vector<char_t> chars;
+    
+    virtual void consume_batch(const index_t* batch_refs, const char_t* batch_chars, const size_t num) override {
+        refs.insert(refs.end(), batch_refs, batch_refs + num);
+        chars.insert(chars.end(), batch_chars, batch_chars + num);
+    }
+    
+    virtual size_t num_factors() const override {
+        return refs.size();
+    }
+};
+
+// writes factors to a stream, encoding each reference using ceil(log2(z+1)) bits, where z is the number of factors
+// written before it, and each character using 8 bits
+template<typename index_t>
+class LZ78Consumer_Stream_Inline {
+private:
+    BitWriter m_out;
+    size_t m_num_factors;
+
+public:
+    inline LZ78Consumer_Stream_Inline(std::ostream& out) : m_out(out), m_num_factors(0) {
+    }
+
+    inline void consume(const index_t ref, const char_t c) {
+        m_out.write(ref, std::bit_width(m_num_factors));
+        m_out.write(uint8_t(c), 8);
+        ++m_num_factors;
+    }
+
+    inline size_t num_factors() const {
+        return m_num_factors;
+    }
+
+    inline void finish() {
+        m_out.finish();
+    }
+
+    inline size_t bytes_written() const {
+        return m_out.bytes_written();
+    }
+};
+
+template<typename index_t>
+class LZ78Consumer_Stream_Interface : public ILZ78Consumer<index_t> {
+private:
+    LZ78Consumer_Stream_Inline<index_t> m_consumer;
+
+public:
+    inline LZ78Consumer_Stream_Interface(std::ostream& out) : m_consumer(out) {
+    }
+
+    virtual void consume(const index_t ref, const char_t c) override {
+        m_consumer.consume(ref, c);
+    }
+
+    virtual size_t num_factors() const override {
+        return m_consumer.num_factors();
+    }
+
+    inline void finish() {
+        m_consumer.finish();
+    }
+
+    inline size_t bytes_written() const {
+        return m_consumer.bytes_written();
+    }
+};
+
+template<typename index_t>
+struct LZ78Consumer_Dummy : public ILZ78Consumer<index_t> {
     virtual void consume(const index_t ref, const char_t c) override { }
     virtual size_t num_factors() const override { return 0; }
 };
+
+template<typename index_t>
+struct LZ78BatchConsumer_Dummy : public ILZ78BatchConsumer<index_t> {
+    virtual void consume_batch(const index_t* refs, const char_t* chars, const size_t num) override { }
+    virtual size_t num_factors() const override { return 0; }
+};
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include <util/typedefs.hpp>
+
+// reconstructs the text from a stream of LZ78 factors
+//
+// Instead of walking from every factor up to the root, the decoder materializes the start position and length of
+// every phrase in the decoded text. Since a factor only refers to earlier factors, its phrase is a copy of the
+// already decoded phrase it refers to, followed by one character.
+//
+// Phrases are copied in 16-byte steps. This may overshoot the end of a phrase, which is harmless because the
+// following phrase overwrites it, and the buffer keeps some slack at the end.
+template<typename index_t>
+class LZ78Decoder {
+private:
+    static constexpr size_t STEP = 16;
+
+    std::vector<size_t> m_start;   // start position of each phrase in the text
+    std::vector<index_t> m_length; // length of each phrase
+    std::vector<char_t> m_text;
+    size_t m_size;
+
+public:
+    inline LZ78Decoder() : m_size(0) {
+        // factor 0 is the empty phrase
+        m_start.emplace_back(0);
+        m_length.emplace_back(0);
+    }
+
+    // decodes the given factors and appends them to the text
+    // this can be called repeatedly, factor ids continue where the previous call left off
+    inline void decode(const index_t* refs, const char_t* chars, const size_t num_factors) {
+        const size_t first = m_start.size();
+
+        // materialize phrase lengths and start positions
+        m_start.resize(first + num_factors);
+        m_length.resize(first + num_factors);
+
+        size_t pos = m_size;
+        for(size_t j = 0; j < num_factors; j++) {
+            const index_t len = m_length[refs[j]] + 1;
+            m_start[first + j] = pos;
+            m_length[first + j] = len;
+            pos += len;
+        }
+
+        // copy phrases
+        m_text.resize(pos + STEP);
+        char_t* text = m_text.data();
+        for(size_t j = 0; j < num_factors; j++) {
+            const auto ref = refs[j];
+            const char_t* src = text + m_start[ref];
+            char_t* dst = text + m_start[first + j];
+            const size_t len = m_length[ref];
+            for(size_t k = 0; k < len; k += STEP) {
+                std::memmove(dst + k, src + k, STEP); // may overlap if the phrases are adjacent
+            }
+            dst[len] = chars[j];
+        }
+        m_size = pos;
+    }
+
+    // cuts the text to at most the given length
+    // the sequential compressors end an unfinished final phrase with character 0, which can be dropped this way
+    inline void truncate(const size_t n) {
+        m_size = std::min(m_size, n);
+    }
+
+    inline const char_t* data() const {
+        return m_text.data();
+    }
+
+    inline size_t size() const {
+        return m_size;
+    }
+
+    inline size_t num_factors() const {
+        return m_start.size() - 1;
+    }
+};
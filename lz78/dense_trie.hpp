@@ -0,0 +1,110 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <util/typedefs.hpp>
+
+#include "interfaces.hpp"
+
+// LZ78 trie for small alphabets that stores the children of each node in a dense array of size sigma
+//
+// Characters are remapped to ranks 0..sigma-1 in the order of their first insertion, so finding a child takes one
+// lookup in the (cached) rank table and a single load from the child array. The input must contain at most sigma
+// distinct characters, otherwise insert_child aborts; lz78.cpp measures the alphabet beforehand and picks the
+// smallest instantiation that fits.
+template<typename index_t, size_t sigma>
+class DenseTrie_Inline {
+public:
+    using index_type = index_t;
+
+private:
+    static constexpr index_t ROOT = 0;
+    static constexpr uint8_t NONE = 0xFF; // rank of characters that have not been inserted yet
+
+    static_assert(sigma > 0 && sigma < NONE);
+
+    std::vector<index_t> m_children; // sigma entries per node, ROOT if there is no child
+    uint8_t m_rank[256];
+    size_t m_num_ranks;
+
+public:
+    inline DenseTrie_Inline() : m_num_ranks(0) {
+        std::fill(m_rank, m_rank + 256, NONE);
+
+        m_children.reserve(16 * sigma);
+        m_children.resize(sigma, ROOT); // node 0 is the root
+    }
+
+    // removes all nodes but the root, keeping the allocated memory for reuse
+    inline void clear() {
+        m_num_ranks = 0;
+        std::fill(m_rank, m_rank + 256, NONE);
+
+        m_children.clear();
+        m_children.resize(sigma, ROOT);
+    }
+
+    inline index_t root() const {
+        return ROOT;
+    }
+
+    inline size_t size() const {
+        return m_children.size() / sigma;
+    }
+
+    inline index_t get_child(const index_t node, const char_t c) {
+        const auto r = m_rank[(uint8_t)c];
+        return r != NONE ? m_children[size_t(node) * sigma + r] : ROOT;
+    }
+
+    inline index_t insert_child(const index_t parent, const char_t c) {
+        auto& r = m_rank[(uint8_t)c];
+        if(r == NONE) {
+            // only happens once per character, so checking the alphabet size is free
+            if(m_num_ranks == sigma) {
+                std::cerr << "DenseTrie_Inline: more than " << sigma << " distinct characters" << std::endl;
+                std::abort();
+            }
+            r = (uint8_t)m_num_ranks++;
+        }
+
+        const index_t new_child = (index_t)size();
+        m_children.resize(m_children.size() + sigma, ROOT);
+        m_children[size_t(parent) * sigma + r] = new_child;
+        return new_child;
+    }
+
+    inline void print_stats(std::ostream& out) const {
+        out << "sigma=" << sigma << " ranks=" << m_num_ranks << " bytes=" << (m_children.capacity() * sizeof(index_t) + sizeof(m_rank));
+    }
+};
+
+template<typename index_t, size_t sigma>
+class DenseTrie_Interface : public ILZ78Trie<index_t> {
+public:
+    using index_type = index_t;
+
+private:
+    DenseTrie_Inline<index_t, sigma> m_trie;
+
+public:
+    virtual index_t root() const override {
+        return m_trie.root();
+    }
+
+    virtual size_t size() const override {
+        return m_trie.size();
+    }
+
+    virtual index_t get_child(const index_t node, const char_t c) override {
+        return m_trie.get_child(node, c);
+    }
+
+    virtual index_t insert_child(const index_t parent, const char_t c) override {
+        return m_trie.insert_child(parent, c);
+    }
+};
@@ -0,0 +1,220 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <variant>
+
+#include <util/small_function.hpp>
+#include <util/typedefs.hpp>
+
+// tries and consumers whose implementation is chosen at runtime, dispatched without virtual methods
+//
+// The adapters provide the interface of the inline types, so they can be passed to LZ78_TT. Trie adapters take
+// ownership of the trie they are constructed from; consumer adapters refer to a consumer owned by the caller.
+
+// dispatch via std::visit over a std::variant of the alternatives
+template<typename index_t, typename... Tries>
+class LZ78Trie_Variant {
+public:
+    using index_type = index_t;
+
+private:
+    std::variant<Tries...> m_trie;
+
+public:
+    template<typename Trie>
+    inline LZ78Trie_Variant(Trie trie) : m_trie(std::move(trie)) {
+    }
+
+    inline index_t root() const {
+        return std::visit([](const auto& t){ return index_t(t.root()); }, m_trie);
+    }
+
+    inline size_t size() const {
+        return std::visit([](const auto& t){ return size_t(t.size()); }, m_trie);
+    }
+
+    inline index_t get_child(const index_t node, const char_t c) {
+        return std::visit([&](auto& t){ return index_t(t.get_child(node, c)); }, m_trie);
+    }
+
+    inline index_t insert_child(const index_t parent, const char_t c) {
+        return std::visit([&](auto& t){ return index_t(t.insert_child(parent, c)); }, m_trie);
+    }
+};
+
+template<typename index_t, typename... Consumers>
+class LZ78Consumer_Variant {
+private:
+    std::variant<Consumers*...> m_consumer;
+
+public:
+    template<typename Consumer>
+    inline LZ78Consumer_Variant(Consumer& consumer) : m_consumer(&consumer) {
+    }
+
+    inline void consume(const index_t ref, const char_t c) {
+        std::visit([&](auto* x){ x->consume(ref, c); }, m_consumer);
+    }
+
+    inline size_t num_factors() const {
+        return std::visit([](const auto* x){ return size_t(x->num_factors()); }, m_consumer);
+    }
+};
+
+// dispatch via a table of plain function pointers per implementation
+template<typename index_t>
+class LZ78Trie_FunctionPointers {
+public:
+    using index_type = index_t;
+
+private:
+    struct Table {
+        index_t (*root)(const void*);
+        size_t (*size)(const void*);
+        index_t (*get_child)(void*, index_t, char_t);
+        index_t (*insert_child)(void*, index_t, char_t);
+        void (*destroy)(void*);
+    };
+
+    template<typename Trie>
+    static constexpr Table TABLE = {
+        [](const void* t) -> index_t { return ((const Trie*)t)->root(); },
+        [](const void* t) -> size_t { return ((const Trie*)t)->size(); },
+        [](void* t, index_t node, char_t c) -> index_t { return ((Trie*)t)->get_child(node, c); },
+        [](void* t, index_t parent, char_t c) -> index_t { return ((Trie*)t)->insert_child(parent, c); },
+        [](void* t) { delete (Trie*)t; }
+    };
+
+    std::unique_ptr<void, void(*)(void*)> m_trie;
+    const Table* m_table;
+
+public:
+    template<typename Trie>
+    inline LZ78Trie_FunctionPointers(Trie trie) : m_trie(new Trie(std::move(trie)), TABLE<Trie>.destroy), m_table(&TABLE<Trie>) {
+    }
+
+    inline index_t root() const {
+        return m_table->root(m_trie.get());
+    }
+
+    inline size_t size() const {
+        return m_table->size(m_trie.get());
+    }
+
+    inline index_t get_child(const index_t node, const char_t c) {
+        return m_table->get_child(m_trie.get(), node, c);
+    }
+
+    inline index_t insert_child(const index_t parent, const char_t c) {
+        return m_table->insert_child(m_trie.get(), parent, c);
+    }
+};
+
+template<typename index_t>
+class LZ78Consumer_FunctionPointers {
+private:
+    struct Table {
+        void (*consume)(void*, index_t, char_t);
+        size_t (*num_factors)(const void*);
+    };
+
+    template<typename Consumer>
+    static constexpr Table TABLE = {
+        [](void* x, index_t ref, char_t c) { ((Consumer*)x)->consume(ref, c); },
+        [](const void* x) -> size_t { return ((const Consumer*)x)->num_factors(); }
+    };
+
+    void* m_consumer;
+    const Table* m_table;
+
+public:
+    template<typename Consumer>
+    inline LZ78Consumer_FunctionPointers(Consumer& consumer) : m_consumer(&consumer), m_table(&TABLE<Consumer>) {
+    }
+
+    inline void consume(const index_t ref, const char_t c) {
+        m_table->consume(m_consumer, ref, c);
+    }
+
+    inline size_t num_factors() const {
+        return m_table->num_factors(m_consumer);
+    }
+};
+
+// dispatch via one type-erased callable per method, e.g., std::function or SmallFunction
+template<typename index_t, template<typename> typename Function>
+class LZ78Trie_Erased {
+public:
+    using index_type = index_t;
+
+private:
+    std::shared_ptr<void> m_trie;
+
+    Function<index_t()> m_root;
+    Function<size_t()> m_size;
+    Function<index_t(index_t, char_t)> m_get_child;
+    Function<index_t(index_t, char_t)> m_insert_child;
+
+public:
+    template<typename Trie>
+    inline LZ78Trie_Erased(Trie trie) {
+        Trie* t = new Trie(std::move(trie));
+        m_trie = std::shared_ptr<Trie>(t);
+        m_root = [t](){ return index_t(t->root()); };
+        m_size = [t](){ return size_t(t->size()); };
+        m_get_child = [t](index_t node, char_t c){ return index_t(t->get_child(node, c)); };
+        m_insert_child = [t](index_t parent, char_t c){ return index_t(t->insert_child(parent, c)); };
+    }
+
+    inline index_t root() const {
+        return m_root();
+    }
+
+    inline size_t size() const {
+        return m_size();
+    }
+
+    inline index_t get_child(const index_t node, const char_t c) {
+        return m_get_child(node, c);
+    }
+
+    inline index_t insert_child(const index_t parent, const char_t c) {
+        return m_insert_child(parent, c);
+    }
+};
+
+template<typename index_t, template<typename> typename Function>
+class LZ78Consumer_Erased {
+private:
+    Function<void(index_t, char_t)> m_consume;
+    Function<size_t()> m_num_factors;
+
+public:
+    template<typename Consumer>
+    inline LZ78Consumer_Erased(Consumer& consumer) {
+        Consumer* x = &consumer;
+        m_consume = [x](index_t ref, char_t c){ x->consume(ref, c); };
+        m_num_factors = [x](){ return size_t(x->num_factors()); };
+    }
+
+    inline void consume(const index_t ref, const char_t c) {
+        m_consume(ref, c);
+    }
+
+    inline size_t num_factors() const {
+        return m_num_factors();
+    }
+};
+
+template<typename index_t>
+using LZ78Trie_Function = LZ78Trie_Erased<index_t, std::function>;
+
+template<typename index_t>
+using LZ78Consumer_Function = LZ78Consumer_Erased<index_t, std::function>;
+
+template<typename index_t>
+using LZ78Trie_SmallFunction = LZ78Trie_Erased<index_t, SmallFunction>;
+
+template<typename index_t>
+using LZ78Consumer_SmallFunction = LZ78Consumer_Erased<index_t, SmallFunction>;
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <bit>
+
+#include <util/bit_reader.hpp>
+#include <util/typedefs.hpp>
+
+// reads factors written by an LZ78Consumer_Stream_Inline or LZ78Consumer_Stream_Interface
+template<typename index_t>
+class LZ78FactorReader {
+private:
+    BitReader m_in;
+    size_t m_num_factors;
+
+public:
+    inline LZ78FactorReader(std::istream& in) : m_in(in), m_num_factors(0) {
+    }
+
+    // reads the next factor, returns false if there is none
+    inline bool read(index_t& ref, char_t& c) {
+        const size_t ref_bits = std::bit_width(m_num_factors);
+        if(m_in.available(ref_bits + 8) < ref_bits + 8) return false;
+
+        ref = (index_t)m_in.read(ref_bits);
+        c = (char_t)m_in.read(8);
+        ++m_num_factors;
+        return true;
+    }
+
+    inline size_t num_factors() const {
+        return m_num_factors;
+    }
+};
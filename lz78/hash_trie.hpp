@@ -0,0 +1,223 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <utility>
+
+#include <util/typedefs.hpp>
+
+#include "interfaces.hpp"
+
+// LZ78 trie that stores edges (parent, c) -> child in an open addressing hash table with linear probing.
+//
+// When the load factor is exceeded, a table of twice the capacity is allocated and the entries of the old table
+// are migrated a few slots at a time with each following insertion, so no single insertion has to rehash everything.
+// Tables are obtained via calloc so that growing does not have to touch (zero) the new memory eagerly.
+template<typename index_t>
+class HashTrie_Inline {
+public:
+    using index_type = index_t;
+
+private:
+    static constexpr index_t ROOT = 0;
+
+    static constexpr size_t INITIAL_CAPACITY = 1024;
+    static constexpr size_t MIGRATE_PER_INSERT = 4;
+    static constexpr size_t MAX_LOAD_NUM = 3; // max load factor is 3/4
+    static constexpr size_t MAX_LOAD_DEN = 4;
+
+    struct Slot {
+        index_t parent;
+        index_t child; // ROOT marks an empty slot, because the root is nobody's child
+        char_t c;
+    };
+
+    class Table {
+    private:
+        Slot* m_slots;
+        size_t m_capacity;
+        size_t m_mask;
+        size_t m_shift;
+        size_t m_size;
+
+        static inline size_t hash(const index_t parent, const char_t c) {
+            return size_t(((uint64_t(parent) << 8) | uint8_t(c)) * 0x9E3779B97F4A7C15ULL);
+        }
+
+    public:
+        inline Table() : m_slots(nullptr), m_capacity(0), m_mask(0), m_shift(0), m_size(0) {
+        }
+
+        inline Table(const size_t capacity) : m_capacity(capacity), m_mask(capacity - 1), m_size(0) {
+            m_slots = (Slot*)std::calloc(capacity, sizeof(Slot));
+            m_shift = 64 - __builtin_ctzll(capacity);
+        }
+
+        inline Table(const Table& other) : Table() {
+            *this = other;
+        }
+
+        inline Table(Table&& other) : Table() {
+            *this = std::move(other);
+        }
+
+        inline ~Table() {
+            std::free(m_slots);
+        }
+
+        inline Table& operator=(const Table& other) {
+            if(this != &other) {
+                std::free(m_slots);
+                m_slots = other.m_slots ? (Slot*)std::malloc(other.m_capacity * sizeof(Slot)) : nullptr;
+                if(m_slots) std::memcpy(m_slots, other.m_slots, other.m_capacity * sizeof(Slot));
+                m_capacity = other.m_capacity;
+                m_mask = other.m_mask;
+                m_shift = other.m_shift;
+                m_size = other.m_size;
+            }
+            return *this;
+        }
+
+        inline Table& operator=(Table&& other) {
+            std::swap(m_slots, other.m_slots);
+            std::swap(m_capacity, other.m_capacity);
+            std::swap(m_mask, other.m_mask);
+            std::swap(m_shift, other.m_shift);
+            std::swap(m_size, other.m_size);
+            return *this;
+        }
+
+        inline operator bool() const {
+            return m_slots != nullptr;
+        }
+
+        inline size_t capacity() const {
+            return m_capacity;
+        }
+
+        inline size_t size() const {
+            return m_size;
+        }
+
+        inline bool full() const {
+            return (m_size + 1) * MAX_LOAD_DEN > m_capacity * MAX_LOAD_NUM;
+        }
+
+        inline const Slot& slot(const size_t i) const {
+            return m_slots[i];
+        }
+
+        inline index_t find(const index_t parent, const char_t c) const {
+            size_t i = hash(parent, c) >> m_shift;
+            while(true) {
+                const Slot& s = m_slots[i];
+                if(s.child == ROOT) return ROOT;
+                if(s.parent == parent && s.c == c) return s.child;
+                i = (i + 1) & m_mask;
+            }
+        }
+
+        inline void insert(const index_t parent, const char_t c, const index_t child) {
+            size_t i = hash(parent, c) >> m_shift;
+            while(m_slots[i].child != ROOT) {
+                i = (i + 1) & m_mask;
+            }
+            m_slots[i] = Slot { parent, child, c };
+            ++m_size;
+        }
+    };
+
+    Table m_table; // receives all insertions
+    Table m_old;   // previous table, read-only while its entries are being migrated
+    size_t m_migrate;
+
+    size_t m_size;
+
+    inline void migrate() {
+        const size_t end = std::min(m_migrate + MIGRATE_PER_INSERT, m_old.capacity());
+        for(; m_migrate < end; m_migrate++) {
+            const Slot& s = m_old.slot(m_migrate);
+            if(s.child != ROOT) m_table.insert(s.parent, s.c, s.child);
+        }
+
+        if(m_migrate == m_old.capacity()) {
+            m_old = Table();
+        }
+    }
+
+    inline void grow() {
+        // finish any pending migration (doesn't happen with the chosen constants)
+        while(m_old) migrate();
+
+        m_old = std::move(m_table);
+        m_table = Table(2 * m_old.capacity());
+        m_migrate = 0;
+    }
+
+public:
+    inline HashTrie_Inline() : m_table(INITIAL_CAPACITY), m_migrate(0), m_size(1) { // node 0 is the root
+    }
+
+    // removes all nodes but the root
+    // a large table is not kept, because zeroing it would cost more than allocating a new one via calloc
+    inline void clear() {
+        m_table = Table(INITIAL_CAPACITY);
+        m_old = Table();
+        m_migrate = 0;
+        m_size = 1;
+    }
+
+    inline index_t root() const {
+        return ROOT;
+    }
+
+    inline size_t size() const {
+        return m_size;
+    }
+
+    inline index_t get_child(const index_t node, const char_t c) {
+        const auto v = m_table.find(node, c);
+        return (v == ROOT && m_old) ? m_old.find(node, c) : v;
+    }
+
+    inline index_t insert_child(const index_t parent, const char_t c) {
+        if(m_table.full()) grow();
+
+        const index_t new_child = (index_t)m_size++;
+        m_table.insert(parent, c, new_child);
+        if(m_old) migrate();
+        return new_child;
+    }
+
+    inline void print_stats(std::ostream& out) const {
+        out << "bytes=" << ((m_table.capacity() + m_old.capacity()) * sizeof(Slot));
+    }
+};
+
+template<typename index_t>
+class HashTrie_Interface : public ILZ78Trie<index_t> {
+public:
+    using index_type = index_t;
+
+private:
+    HashTrie_Inline<index_t> m_trie;
+
+public:
+    virtual index_t root() const override {
+        return m_trie.root();
+    }
+
+    virtual size_t size() const override {
+        return m_trie.size();
+    }
+
+    virtual index_t get_child(const index_t node, const char_t c) override {
+        return m_trie.get_child(node, c);
+    }
+
+    virtual index_t insert_child(const index_t parent, const char_t c) override {
+        return m_trie.insert_child(parent, c);
+    }
+};
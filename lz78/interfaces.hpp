@@ -2,12 +2,23 @@
 
 #include <util/typedefs.hpp>
 
+template<typename index_t>
 class ILZ78Consumer {
 public:
     virtual void consume(const index_t ref, const char_t c) = 0;
     virtual size_t num_factors() const = 0;
 };
 
+// consumes factors in batches to amortize the cost of virtual calls
+template<typename index_t>
+class ILZ78BatchConsumer {
+public:
+    virtual ~ILZ78BatchConsumer() = default;
+    virtual void consume_batch(const index_t* refs, const char_t* chars, const size_t num) = 0;
+    virtual size_t num_factors() const = 0;
+};
+
+template<typename index_t>
 class ILZ78Trie {
 public:
     virtual index_t root() const = 0;
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <vector>
+
+#include "interfaces.hpp"
+#include <util/async_reader.hpp>
+#include <util/buffered_reader.hpp>
+#include <util/typedefs.hpp>
+
+template<typename index_t>
+class LZ78_IB {
+private:
+    ILZ78BatchConsumer<index_t>* m_consumer;
+    
+    ILZ78Trie<index_t>* m_trie;
+    index_t m_current;
+    
+    // factors are collected locally and passed to the consumer in batches
+    std::vector<index_t> m_refs;
+    std::vector<char_t> m_chars;
+    size_t m_batch_size;
+    size_t m_num_buffered;
+    
+    inline void flush() {
+        m_consumer->consume_batch(m_refs.data(), m_chars.data(), m_num_buffered);
+        m_num_buffered = 0;
+    }
+    
+    inline void consume(const index_t ref, const char_t c) {
+        m_refs[m_num_buffered] = ref;
+        m_chars[m_num_buffered] = c;
+        if(++m_num_buffered == m_batch_size) flush();
+    }
+
+    inline void process(const char_t c) {
+        // try to navigate trie
+        auto child = m_trie->get_child(m_current, c);
+        if(child) {
+            m_current = child;
+        } else {
+            consume(m_current, c);
+            m_trie->insert_child(m_current, c);
+            m_current = m_trie->root();
+        }
+    }
+    
+    inline void finish() {
+        // possibly output final factor
+        if(m_current) {
+            consume(m_current, 0);
+        }
+        
+        if(m_num_buffered) flush();
+    }
+
+public:
+    inline LZ78_IB(ILZ78Trie<index_t>* trie, ILZ78BatchConsumer<index_t>* consumer, const size_t batch_size)
+        : m_consumer(consumer), m_trie(trie), m_refs(batch_size), m_chars(batch_size), m_batch_size(batch_size), m_num_buffered(0) {
+        m_current = m_trie->root();
+    }
+    
+    inline void compress(std::istream& in) {
+        // process stream
+        BufferedReader<char_t> r(in, 1024 * 1024 * 1024); // 1Gi
+        while(r) {
+            process(r.read());
+        }
+        finish();
+    }
+    
+    inline void compress(const char_t* text, const size_t n) {
+        // process text in memory
+        for(size_t i = 0; i < n; i++) {
+            process(text[i]);
+        }
+        finish();
+    }
+    
+    inline void compress(AsyncReader<char_t>& in) {
+        // process buffers as they are read in the background
+        AsyncReader<char_t>::Block block;
+        while(in.next(block)) {
+            for(size_t i = 0; i < block.size; i++) {
+                process(block.data[i]);
+            }
+        }
+        finish();
+    }
+};
@@ -1,41 +1,67 @@
 #pragma once
 
 #include "interfaces.hpp"
+#include <util/async_reader.hpp>
 #include <util/buffered_reader.hpp>
 #include <util/typedefs.hpp>
 
+template<typename index_t>
 class LZ78_II {
 private:
-    ILZ78Trie* m_trie;
-    ILZ78Consumer* m_consumer;
+    ILZ78Trie<index_t>* m_trie;
+    ILZ78Consumer<index_t>* m_consumer;
     
     index_t m_current;
 
+    inline void process(const char_t c) {
+        // try to navigate trie
+        auto child = m_trie->get_child(m_current, c);
+        if(child) {
+            m_current = child;
+        } else {
+            m_consumer->consume(m_current, c);
+            m_trie->insert_child(m_current, c);
+            m_current = m_trie->root();
+        }
+    }
+    
+    inline void finish() {
+        // possibly output final factor
+        if(m_current) {
+            m_consumer->consume(m_current, 0);
+        }
+    }
+
 public:
-    inline LZ78_II(ILZ78Trie* trie, ILZ78Consumer* consumer) : m_trie(trie), m_consumer(consumer) {
+    inline LZ78_II(ILZ78Trie<index_t>* trie, ILZ78Consumer<index_t>* consumer) : m_trie(trie), m_consumer(consumer) {
         m_current = m_trie->root();
     }
     
     inline void compress(std::istream& in) {
         // process stream
-        BufferedReader<char_t> r(in, 1024 * 1024 * 1024); // 1Mi
+        BufferedReader<char_t> r(in, 1024 * 1024 * 1024); // 1Gi
         while(r) {
-            const auto c = r.read();
-            
-            // try to navigate trie
-            auto child = m_trie->get_child(m_current, c);
-            if(child) {
-                m_current = child;
-            } else {
-                m_consumer->consume(m_current, c);
-                m_trie->insert_child(m_current, c);
-                m_current = m_trie->root();
-            }
+            process(r.read());
         }
-        
-        // possibly output final factor
-        if(m_current) {
-            m_consumer->consume(m_current, 0);
+        finish();
+    }
+    
+    inline void compress(const char_t* text, const size_t n) {
+        // process text in memory
+        for(size_t i = 0; i < n; i++) {
+            process(text[i]);
+        }
+        finish();
+    }
+    
+    inline void compress(AsyncReader<char_t>& in) {
+        // process buffers as they are read in the background
+        AsyncReader<char_t>::Block block;
+        while(in.next(block)) {
+            for(size_t i = 0; i < block.size; i++) {
+                process(block.data[i]);
+            }
         }
+        finish();
     }
 };
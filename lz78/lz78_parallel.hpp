@@ -0,0 +1,133 @@
+#pragma once
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include "consumers.hpp"
+#include <util/typedefs.hpp>
+
+// block-parallel LZ78 factorization of an in-memory text
+//
+// The text is split into blocks that are factorized independently on worker threads, each with its own trie.
+// Optionally, a prefix of the text (the seed) is factorized first and the resulting trie is copied into every
+// worker, so that the blocks can refer to the seed's phrases.
+//
+// The factors of all blocks form a single stream: factor ids are global (the i-th factor of the stream has id i,
+// id 0 is the empty phrase) and every reference points to an earlier factor of the stream. To make this possible,
+// a phrase left unfinished at the end of a block is emitted as its parent's id plus its last character rather than
+// with a zero character.
+template<typename Trie>
+class LZ78_Parallel {
+private:
+    using index_t = typename Trie::index_type;
+
+public:
+    struct Block {
+        size_t begin, end; // position of the block in the text
+        LZ78Consumer_Inline<index_t> factors;
+    };
+
+private:
+    size_t m_num_threads;
+    size_t m_seed_size;
+
+    std::vector<Block> m_blocks;
+
+    static void factorize(Trie& trie, const char_t* text, const size_t n, LZ78Consumer_Inline<index_t>& consumer) {
+        const auto root = trie.root();
+        auto current = root;
+        auto parent = root;
+        char_t last = 0;
+
+        for(size_t i = 0; i < n; i++) {
+            const auto c = text[i];
+
+            // try to navigate trie
+            auto child = trie.get_child(current, c);
+            if(child) {
+                parent = current;
+                last = c;
+                current = child;
+            } else {
+                consumer.consume(current, c);
+                trie.insert_child(current, c);
+                current = root;
+            }
+        }
+
+        // possibly output final factor, which equals the phrase of the current node
+        if(current != root) {
+            consumer.consume(parent, last);
+        }
+    }
+
+    // translates the trie node ids in a block into global factor ids
+    // nodes up to seed_nodes belong to the seed, whose factor ids are equal to its node ids
+    static void remap(LZ78Consumer_Inline<index_t>& consumer, const size_t seed_nodes, const size_t base) {
+        for(auto& ref : consumer.refs) {
+            if(ref > seed_nodes) ref = base + (ref - seed_nodes);
+        }
+    }
+
+public:
+    inline LZ78_Parallel(const size_t num_threads, const size_t seed_size = 0)
+        : m_num_threads(std::max(num_threads, size_t(1))), m_seed_size(seed_size) {
+    }
+
+    inline void compress(const char_t* text, const size_t n) {
+        m_blocks.clear();
+
+        // seed phase
+        Trie seed_trie;
+        const size_t seed_size = std::min(m_seed_size, n);
+        if(seed_size > 0) {
+            m_blocks.emplace_back(Block { 0, seed_size, {} });
+            factorize(seed_trie, text, seed_size, m_blocks.back().factors);
+        }
+        const size_t seed_nodes = seed_trie.size() - 1;
+
+        // parallel phase
+        const size_t first = m_blocks.size();
+        {
+            const size_t remaining = n - seed_size;
+            const size_t block_size = (remaining + m_num_threads - 1) / m_num_threads;
+            for(size_t begin = seed_size; begin < n; begin += block_size) {
+                m_blocks.emplace_back(Block { begin, std::min(begin + block_size, n), {} });
+            }
+        }
+
+        {
+            std::vector<std::thread> workers;
+            for(size_t b = first; b < m_blocks.size(); b++) {
+                workers.emplace_back([&, b](){
+                    auto& block = m_blocks[b];
+                    Trie trie(seed_trie);
+                    factorize(trie, text + block.begin, block.end - block.begin, block.factors);
+                });
+            }
+            for(auto& t : workers) t.join();
+        }
+
+        // offset references
+        {
+            std::vector<std::thread> workers;
+            size_t base = (first > 0) ? m_blocks[0].factors.num_factors() : 0;
+            for(size_t b = first; b < m_blocks.size(); b++) {
+                workers.emplace_back([&, b, base](){ remap(m_blocks[b].factors, seed_nodes, base); });
+                base += m_blocks[b].factors.num_factors();
+            }
+            for(auto& t : workers) t.join();
+        }
+    }
+
+    inline const std::vector<Block>& blocks() const {
+        return m_blocks;
+    }
+
+    inline size_t num_factors() const {
+        size_t z = 0;
+        for(const auto& block : m_blocks) z += block.factors.num_factors();
+        return z;
+    }
+};
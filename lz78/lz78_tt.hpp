@@ -1,40 +1,82 @@
 #pragma once
 
+#include <util/async_reader.hpp>
 #include <util/buffered_reader.hpp>
 
 template<typename Trie, typename Consumer>
 class LZ78_TT {
 private:
+    using index_t = typename Trie::index_type;
+    
     Consumer* m_consumer;
     Trie m_trie;
     
     index_t m_current;
 
+    inline void process(const char_t c) {
+        // try to navigate trie
+        auto child = m_trie.get_child(m_current, c);
+        if(child) {
+            m_current = child;
+        } else {
+            m_consumer->consume(m_current, c);
+            m_trie.insert_child(m_current, c);
+            m_current = m_trie.root();
+        }
+    }
+    
+    inline void finish() {
+        // possibly output final factor
+        if(m_current) {
+            m_consumer->consume(m_current, 0);
+        }
+    }
+
 public:
     inline LZ78_TT(Consumer& consumer) : m_consumer(&consumer) {
         m_current = m_trie.root();
     }
     
+    // starts with the given trie, e.g., an adapter whose implementation is chosen at runtime
+    inline LZ78_TT(Trie&& trie, Consumer& consumer) : m_consumer(&consumer), m_trie(std::move(trie)) {
+        m_current = m_trie.root();
+    }
+    
+    // clears the trie to compress another input, keeping its memory
+    inline void reset() {
+        m_trie.clear();
+        m_current = m_trie.root();
+    }
+    
+    inline const Trie& trie() const {
+        return m_trie;
+    }
+    
     inline void compress(std::istream& in) {
         // process stream
-        BufferedReader<char_t> r(in, 1024 * 1024 * 1024); // 1Mi
+        BufferedReader<char_t> r(in, 1024 * 1024 * 1024); // 1Gi
         while(r) {
-            const auto c = r.read();
-            
-            // try to navigate trie
-            auto child = m_trie.get_child(m_current, c);
-            if(child) {
-                m_current = child;
-            } else {
-                m_consumer->consume(m_current, c);
-                m_trie.insert_child(m_current, c);
-                m_current = m_trie.root();
-            }
+            process(r.read());
         }
-        
-        // possibly output final factor
-        if(m_current) {
-            m_consumer->consume(m_current, 0);
+        finish();
+    }
+    
+    inline void compress(const char_t* text, const size_t n) {
+        // process text in memory
+        for(size_t i = 0; i < n; i++) {
+            process(text[i]);
+        }
+        finish();
+    }
+    
+    inline void compress(AsyncReader<char_t>& in) {
+        // process buffers as they are read in the background
+        AsyncReader<char_t>::Block block;
+        while(in.next(block)) {
+            for(size_t i = 0; i < block.size; i++) {
+                process(block.data[i]);
+            }
         }
+        finish();
     }
 };
@@ -1,11 +1,17 @@
 #pragma once
 
+#include <iostream>
 #include <vector>
+#include <util/chunked_vector.hpp>
 #include <util/typedefs.hpp>
 
 #include "interfaces.hpp"
 
-class BinaryTrie_Interface : public ILZ78Trie {
+template<typename index_t>
+class BinaryTrie_Interface : public ILZ78Trie<index_t> {
+public:
+    using index_type = index_t;
+
 private:
     static constexpr index_t ROOT = 0;
 
@@ -68,7 +74,11 @@ public:
     }
 };
 
+template<typename index_t>
 class BinaryTrie_Inline {
+public:
+    using index_type = index_t;
+
 private:
     static constexpr index_t ROOT = 0;
 
@@ -93,6 +103,14 @@ public:
         emplace_back(0); // node 0 is the root
     }
 
+    // removes all nodes but the root, keeping the allocated memory for reuse
+    inline void clear() {
+        m_char.clear();
+        m_first_child.clear();
+        m_next_sibling.clear();
+        emplace_back(0);
+    }
+
     inline index_t root() const {
         return ROOT;
     }
@@ -129,9 +147,123 @@ public:
         m_first_child[parent] = new_child;
         return new_child;
     }
+
+    inline void print_stats(std::ostream& out) const {
+        out << "bytes=" << (m_char.capacity() * sizeof(char_t) + m_first_child.capacity() * sizeof(index_t) + m_next_sibling.capacity() * sizeof(index_t));
+    }
 };
 
-struct LZ78Trie_Dummy : public ILZ78Trie {
+// binary trie that stores each node as a single record, so a sibling step touches only one cache line
+// nodes are stored in fixed-size chunks that never move, so growing never copies
+template<typename index_t>
+class ChunkedBinaryTrie_Inline {
+public:
+    using index_type = index_t;
+
+private:
+    static constexpr index_t ROOT = 0;
+
+    struct Node {
+        index_t first_child;
+        index_t next_sibling;
+        char_t c;
+    };
+
+    ChunkedVector<Node> m_nodes;
+
+    index_t emplace_back(char_t c) {
+        const size_t sz = size();
+        m_nodes.emplace_back(Node { ROOT, ROOT, c });
+        return (index_t)sz;
+    }
+
+public:
+    inline ChunkedBinaryTrie_Inline() {
+        emplace_back(0); // node 0 is the root
+    }
+
+    // removes all nodes but the root, keeping the allocated chunks for reuse
+    inline void clear() {
+        m_nodes.clear();
+        emplace_back(0);
+    }
+
+    inline index_t root() const {
+        return ROOT;
+    }
+    
+    inline size_t size() const {
+        return m_nodes.size();
+    }
+    
+    inline index_t get_child(const index_t node, const char_t c) {
+        auto& parent = m_nodes[node];
+        const auto first_child = parent.first_child;
+        auto v = first_child;
+
+        {
+            // MTF
+            Node* prev_sibling = nullptr;
+            Node* x = nullptr;
+            while(v != ROOT && (x = &m_nodes[v])->c != c) {
+                prev_sibling = x;
+                v = x->next_sibling;
+            }
+            
+            if(v && v != first_child) {
+                prev_sibling->next_sibling = x->next_sibling;
+                x->next_sibling = first_child;
+                parent.first_child = v;
+            }
+        }
+        
+        return v;
+    }
+    
+    inline index_t insert_child(const index_t parent, const char_t c) {
+        auto new_child = emplace_back(c);
+        auto& p = m_nodes[parent];
+        m_nodes[new_child].next_sibling = p.first_child;
+        p.first_child = new_child;
+        return new_child;
+    }
+
+    inline void print_stats(std::ostream& out) const {
+        out << "bytes=" << m_nodes.size_bytes();
+    }
+};
+
+template<typename index_t>
+class ChunkedBinaryTrie_Interface : public ILZ78Trie<index_t> {
+public:
+    using index_type = index_t;
+
+private:
+    ChunkedBinaryTrie_Inline<index_t> m_trie;
+
+public:
+    virtual index_t root() const override {
+        return m_trie.root();
+    }
+
+    virtual size_t size() const override {
+        return m_trie.size();
+    }
+
+    virtual index_t get_child(const index_t node, const char_t c) override {
+        return m_trie.get_child(node, c);
+    }
+
+    virtual index_t insert_child(const index_t parent, const char_t c) override {
+        return m_trie.insert_child(parent, c);
+    }
+};
+
+template<typename index_t>
+struct LZ78Trie_Dummy final : public ILZ78Trie<index_t> {
+public:
+    using index_type = index_t;
+
     virtual index_t root() const override { return 0; }
     virtual index_t get_child(const index_t v, const char_t c) override { return 0; }
     virtual index_t insert_child(const index_t v, const char_t c) override { return 0; }
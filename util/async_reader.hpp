@@ -0,0 +1,150 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// reads a stream in the background into a ring of fixed-size buffers
+//
+// A background thread fills the buffers in order while the consumer works on the buffer it was handed last. The
+// buffers are handed out directly, nothing is copied. This is meant for inputs that cannot be mapped into memory,
+// such as pipes.
+//
+// The reader measures the time spent reading the stream and the time the consumer spent waiting for data. The
+// difference is the I/O time that was hidden behind computation.
+template<typename item_t>
+class AsyncReader {
+public:
+    struct Block {
+        const item_t* data;
+        size_t size;
+    };
+
+private:
+    std::istream* m_stream;
+    size_t m_bufsize;
+    size_t m_num_buffers;
+
+    item_t* m_buffers;
+    std::vector<size_t> m_count;
+
+    // buffers [m_head, m_tail) (modulo m_num_buffers) are filled and not yet consumed
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    size_t m_head;
+    size_t m_tail;
+    bool m_end;
+    bool m_stop;
+    bool m_holding; // whether the consumer holds the buffer at m_head
+
+    uint64_t m_io_ns;
+    uint64_t m_wait_ns;
+    size_t m_items_read;
+
+    std::thread m_thread;
+
+    inline static uint64_t now_ns() {
+        using namespace std::chrono;
+        return uint64_t(duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count());
+    }
+
+    inline void fill() {
+        while(true) {
+            size_t slot;
+            {
+                std::unique_lock lock(m_mutex);
+                m_cond.wait(lock, [&](){ return m_stop || m_tail - m_head < m_num_buffers; });
+                if(m_stop) return;
+                slot = m_tail % m_num_buffers;
+            }
+
+            // read without holding the lock
+            const auto t0 = now_ns();
+            m_stream->read((char*)(m_buffers + slot * m_bufsize), m_bufsize * sizeof(item_t));
+            const size_t count = m_stream->gcount() / sizeof(item_t);
+            m_io_ns += now_ns() - t0;
+
+            {
+                std::unique_lock lock(m_mutex);
+                m_count[slot] = count;
+                m_items_read += count;
+                if(count > 0) ++m_tail;
+                if(!*m_stream) m_end = true;
+            }
+            m_cond.notify_all();
+
+            if(!*m_stream) return;
+        }
+    }
+
+public:
+    inline AsyncReader(std::istream& stream, const size_t bufsize, const size_t num_buffers)
+        : m_stream(&stream), m_bufsize(bufsize < 1 ? 1 : bufsize), m_num_buffers(num_buffers < 2 ? 2 : num_buffers),
+          m_head(0), m_tail(0), m_end(false), m_stop(false), m_holding(false),
+          m_io_ns(0), m_wait_ns(0), m_items_read(0) {
+
+        m_buffers = new item_t[m_bufsize * m_num_buffers];
+        m_count.resize(m_num_buffers, 0);
+        m_thread = std::thread([this](){ fill(); });
+    }
+
+    AsyncReader(const AsyncReader&) = delete;
+    AsyncReader& operator=(const AsyncReader&) = delete;
+
+    inline ~AsyncReader() {
+        {
+            std::unique_lock lock(m_mutex);
+            m_stop = true;
+        }
+        m_cond.notify_all();
+        m_thread.join();
+        delete[] m_buffers;
+    }
+
+    // releases the previously returned block and returns the next one
+    // returns false if the stream has ended
+    inline bool next(Block& block) {
+        const auto t0 = now_ns();
+        {
+            std::unique_lock lock(m_mutex);
+            if(m_holding) {
+                ++m_head;
+                m_holding = false;
+                m_cond.notify_all();
+            }
+
+            m_cond.wait(lock, [&](){ return m_head < m_tail || m_end; });
+            if(m_head == m_tail) {
+                m_wait_ns += now_ns() - t0;
+                return false;
+            }
+            m_holding = true;
+        }
+        m_wait_ns += now_ns() - t0;
+
+        const size_t slot = m_head % m_num_buffers;
+        block.data = m_buffers + slot * m_bufsize;
+        block.size = m_count[slot];
+        return true;
+    }
+
+    // the total time spent reading from the stream in nanoseconds
+    // only valid after the stream has ended
+    inline uint64_t io_time_ns() const {
+        return m_io_ns;
+    }
+
+    // the total time the consumer waited for data in nanoseconds
+    inline uint64_t wait_time_ns() const {
+        return m_wait_ns;
+    }
+
+    // the number of items read from the stream
+    inline size_t items_read() const {
+        return m_items_read;
+    }
+};
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "benchmark.hpp"
+
+// an input file of the batch mode
+struct BatchFile {
+    std::string name;
+    size_t size;
+};
+
+// the files of a batch, sorted by decreasing size so that the largest ones are started first
+// the path is either a directory, whose regular files are included recursively, or a file listing one file per line
+inline std::vector<BatchFile> list_batch_files(const std::string& path) {
+    namespace fs = std::filesystem;
+
+    std::vector<BatchFile> files;
+    std::error_code ec;
+    if(fs::is_directory(path, ec)) {
+        for(const auto& entry : fs::recursive_directory_iterator(path, ec)) {
+            if(entry.is_regular_file(ec)) files.emplace_back(BatchFile { entry.path().string(), size_t(entry.file_size(ec)) });
+        }
+    } else {
+        std::ifstream in(path);
+        std::string line;
+        while(std::getline(in, line)) {
+            if(line.empty()) continue;
+            if(fs::is_regular_file(line, ec)) {
+                files.emplace_back(BatchFile { line, size_t(fs::file_size(line, ec)) });
+            } else {
+                std::cerr << "skipping " << line << ", which is not a regular file" << std::endl;
+            }
+        }
+    }
+
+    std::stable_sort(files.begin(), files.end(), [](const BatchFile& a, const BatchFile& b){ return a.size > b.size; });
+    return files;
+}
+
+// the percentiles of the per-file latencies of a batch as key=value pairs
+inline std::string latencies_to_string(const Measurement& latencies) {
+    return " latency_p50_ns=" + std::to_string(latencies.percentile(0.5)) + " latency_p90_ns=" + std::to_string(latencies.percentile(0.9))
+        + " latency_p99_ns=" + std::to_string(latencies.percentile(0.99)) + " latency_max_ns=" + std::to_string(latencies.max());
+}
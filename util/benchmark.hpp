@@ -0,0 +1,322 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+#include "perf_counters.hpp"
+#include "time.hpp"
+
+// the times of the repetitions of a measurement in nanoseconds
+struct Measurement {
+    std::vector<uint64_t> samples;
+    PerfCounters::Values counters; // summed over all repetitions, if measured
+
+    Measurement() = default;
+
+    // a measurement of the given repetitions without performance counters
+    inline explicit Measurement(std::vector<uint64_t> samples) : samples(std::move(samples)) {
+    }
+
+    inline size_t reps() const {
+        return samples.size();
+    }
+
+    inline uint64_t median() const {
+        if(samples.empty()) return 0;
+        auto sorted = samples;
+        std::sort(sorted.begin(), sorted.end());
+        const size_t k = sorted.size() / 2;
+        return sorted.size() % 2 ? sorted[k] : (sorted[k - 1] + sorted[k]) / 2;
+    }
+
+    inline uint64_t min() const {
+        return samples.empty() ? 0 : *std::min_element(samples.begin(), samples.end());
+    }
+
+    inline uint64_t max() const {
+        return samples.empty() ? 0 : *std::max_element(samples.begin(), samples.end());
+    }
+
+    inline double mean() const {
+        double sum = 0;
+        for(const auto x : samples) sum += double(x);
+        return samples.empty() ? 0.0 : sum / double(samples.size());
+    }
+
+    inline double stddev() const {
+        if(samples.size() < 2) return 0.0;
+        const double mu = mean();
+        double sq = 0;
+        for(const auto x : samples) sq += (double(x) - mu) * (double(x) - mu);
+        return std::sqrt(sq / double(samples.size() - 1));
+    }
+
+    // the q-quantile (0 <= q <= 1) using the nearest-rank method, e.g., 0.99 for the 99th percentile
+    inline uint64_t percentile(const double q) const {
+        if(samples.empty()) return 0;
+        auto sorted = samples;
+        std::sort(sorted.begin(), sorted.end());
+        const size_t rank = size_t(std::ceil(q * double(sorted.size())));
+        return sorted[std::clamp(rank, size_t(1), sorted.size()) - 1];
+    }
+
+    // the median in milliseconds, for the time field of RESULT lines
+    inline uint64_t median_ms() const {
+        return median() / 1'000'000;
+    }
+
+    // the statistics as key=value pairs to append to RESULT lines
+    inline std::string to_string() const {
+        return " reps=" + std::to_string(reps()) + " time_median_ns=" + std::to_string(median()) + " time_min_ns=" + std::to_string(min())
+            + " time_stddev_ns=" + std::to_string(uint64_t(stddev()));
+    }
+
+    // the performance counters per repetition and character as key=value pairs, if measured
+    inline std::string counters_to_string(const size_t chars) const {
+        return counters.any() ? counters.to_string(chars * reps()) : "";
+    }
+};
+
+// the throughput in MiB/s of processing the given number of bytes in the given time
+inline double throughput_mib_s(const size_t bytes, const uint64_t ns) {
+    return ns ? (double(bytes) / double(1024 * 1024)) / (double(ns) / 1e9) : 0.0;
+}
+
+// the throughput in MiB/s of the median repetition
+inline double throughput_mib_s(const size_t bytes, const Measurement& m) {
+    return throughput_mib_s(bytes, m.median());
+}
+
+// the thread counts to run scaling experiments with: the powers of two up to the given maximum, and the maximum itself
+inline std::vector<size_t> thread_counts(const size_t max_threads) {
+    std::vector<size_t> counts;
+    for(size_t p = 1; p <= max_threads; p = (p < max_threads && 2 * p > max_threads) ? max_threads : 2 * p) {
+        counts.emplace_back(p);
+    }
+    return counts;
+}
+
+// runs benchmark variants repeatedly and reports statistics over the repetitions
+//
+// All variants run once per round, after the given number of warm-up rounds that are not measured. Optionally, the
+// order of the variants is shuffled in every round, so that no variant always runs in the cache or thermal state left
+// behind by the same predecessor, and the process is pinned to a CPU while single-threaded variants run. After the
+// last round, the variants report their results in the order they were added.
+//
+// With hardware performance counters enabled, the programs start and stop them around the region they time, and the
+// counts are summed over the measured repetitions.
+//
+// Results can additionally be recorded as JSON (one object per line) and CSV. Both files are appended to, so that
+// they collect the results of many runs for tracking regressions.
+class Benchmark {
+public:
+    struct Config {
+        size_t warmup = 0;
+        size_t reps = 1;
+        int cpu = -1; // -1: do not pin
+        bool shuffle = false;
+        bool perf = false;
+        size_t seed = std::random_device()(); // for shuffling, reported so that the order can be reproduced
+        std::string json;
+        std::string csv;
+    };
+
+    using run_t = std::function<uint64_t()>;                  // runs one repetition and returns its time in nanoseconds
+    using report_t = std::function<void(const Measurement&)>; // reports the result after the last round
+
+private:
+    struct Variant {
+        run_t run;
+        report_t report;
+        bool pin;
+        Measurement measurement;
+    };
+
+    Config m_config;
+    std::vector<Variant> m_variants;
+    PerfCounters m_counters;
+    std::mt19937_64 m_gen;
+    bool m_last_round = true;
+    uint64_t m_timestamp;
+
+#ifdef __linux__
+    cpu_set_t m_default_affinity;
+#endif
+
+    inline void set_affinity(const bool pin) {
+#ifdef __linux__
+        if(m_config.cpu < 0) return;
+
+        if(pin) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(m_config.cpu, &set);
+            sched_setaffinity(0, sizeof(set), &set);
+        } else {
+            sched_setaffinity(0, sizeof(m_default_affinity), &m_default_affinity);
+        }
+#endif
+    }
+
+    // splits a list of key=value pairs, separated by spaces
+    inline static std::vector<std::pair<std::string, std::string>> parse(const std::string& result) {
+        std::vector<std::pair<std::string, std::string>> pairs;
+        std::istringstream in(result);
+        std::string token;
+        while(in >> token) {
+            const auto eq = token.find('=');
+            if(eq == std::string::npos) continue;
+
+            auto value = token.substr(eq + 1);
+            if(!value.empty() && value.back() == ',') value.pop_back();
+            pairs.emplace_back(token.substr(0, eq), value);
+        }
+        return pairs;
+    }
+
+    inline static bool is_number(const std::string& s) {
+        if(s.empty() || s.find_first_not_of("0123456789.eE+-") != std::string::npos) return false;
+        char* end;
+        std::strtod(s.c_str(), &end);
+        return *end == 0;
+    }
+
+    inline static std::string json_string(const std::string& s) {
+        std::string out = "\"";
+        for(const auto c : s) {
+            if(c == '"' || c == '\\') out.push_back('\\');
+            out.push_back(c);
+        }
+        return out + "\"";
+    }
+
+    inline static std::string csv_string(const std::string& s) {
+        std::string out = "\"";
+        for(const auto c : s) {
+            if(c == '"') out.push_back('"');
+            out.push_back(c);
+        }
+        return out + "\"";
+    }
+
+public:
+    inline Benchmark() : m_gen(m_config.seed), m_timestamp(uint64_t(std::time(nullptr))) {
+#ifdef __linux__
+        sched_getaffinity(0, sizeof(m_default_affinity), &m_default_affinity);
+#endif
+    }
+
+    inline void configure(const Config& config) {
+        m_config = config;
+        m_config.reps = std::max(m_config.reps, size_t(1));
+        m_gen.seed(m_config.seed);
+        
+        if(m_config.perf && !m_counters.open()) {
+            std::cout << "hardware performance counters are unavailable (" << m_counters.error() << ")" << std::endl;
+        }
+    }
+
+    inline const Config& config() const {
+        return m_config;
+    }
+
+    // the seed of the shuffled order as a key=value pair to append to RESULT lines, if shuffling
+    inline std::string seed_to_string() const {
+        return m_config.shuffle ? " shuffle_seed=" + std::to_string(m_config.seed) : "";
+    }
+
+    // the performance counters, to be started and stopped around the measured region
+    inline PerfCounters& counters() {
+        return m_counters;
+    }
+
+    // adds a variant, pin tells whether it is single-threaded and may be pinned to the CPU
+    inline void add(run_t run, report_t report, const bool pin = true) {
+        m_variants.emplace_back(Variant { std::move(run), std::move(report), pin, Measurement {} });
+    }
+
+    // whether the current round is the last one, e.g., to inspect the result of a variant only once
+    inline bool last_round() const {
+        return m_last_round;
+    }
+
+    // runs all added variants, reports their results and removes them
+    inline void run() {
+        std::vector<size_t> order(m_variants.size());
+        for(size_t i = 0; i < order.size(); i++) order[i] = i;
+
+        const size_t rounds = m_config.warmup + m_config.reps;
+        for(size_t round = 0; round < rounds; round++) {
+            m_last_round = (round + 1 == rounds);
+            if(m_config.shuffle) std::shuffle(order.begin(), order.end(), m_gen);
+
+            for(const auto i : order) {
+                auto& v = m_variants[i];
+                set_affinity(v.pin);
+                m_counters.reset();
+                const auto dt = v.run();
+                if(round >= m_config.warmup) {
+                    v.measurement.samples.emplace_back(dt);
+                    if(m_counters.available()) v.measurement.counters += m_counters.read();
+                }
+            }
+        }
+        set_affinity(false);
+        m_last_round = true;
+
+        for(auto& v : m_variants) v.report(v.measurement);
+        m_variants.clear();
+    }
+
+    // appends a result, given as key=value pairs, and its measurement to the JSON and CSV files, if configured
+    inline void record(const std::string& result, const Measurement& m) const {
+        if(m_config.json.empty() && m_config.csv.empty()) return;
+
+        const auto pairs = parse(result);
+
+        if(!m_config.json.empty()) {
+            std::ofstream out(m_config.json, std::ios::app);
+            out << "{\"timestamp\":" << m_timestamp;
+            for(const auto& [key, value] : pairs) {
+                out << "," << json_string(key) << ":" << (is_number(value) ? value : json_string(value));
+            }
+            out << ",\"warmup\":" << m_config.warmup << ",\"reps\":" << m.reps();
+            if(m_config.shuffle) out << ",\"shuffle_seed\":" << m_config.seed;
+            out
+                << ",\"time_median_ns\":" << m.median() << ",\"time_min_ns\":" << m.min() << ",\"time_max_ns\":" << m.max()
+                << ",\"time_mean_ns\":" << uint64_t(m.mean()) << ",\"time_stddev_ns\":" << uint64_t(m.stddev()) << "}" << std::endl;
+        }
+
+        if(!m_config.csv.empty()) {
+            const bool empty = !std::ifstream(m_config.csv) || std::ifstream(m_config.csv, std::ios::ate).tellg() == 0;
+            std::ofstream out(m_config.csv, std::ios::app);
+            if(empty) {
+                out << "timestamp,algo,input,warmup,reps,shuffle_seed,time_median_ns,time_min_ns,time_max_ns,time_mean_ns,time_stddev_ns,result" << std::endl;
+            }
+
+            std::string algo, input;
+            for(const auto& [key, value] : pairs) {
+                if(key == "algo") algo = value;
+                if(key == "input") input = value;
+            }
+            out << m_timestamp << "," << csv_string(algo) << "," << csv_string(input) << "," << m_config.warmup << "," << m.reps()
+                << "," << (m_config.shuffle ? std::to_string(m_config.seed) : "") << "," << m.median() << "," << m.min() << "," << m.max() << "," << uint64_t(m.mean()) << "," << uint64_t(m.stddev())
+                << "," << csv_string(result) << std::endl;
+        }
+    }
+};
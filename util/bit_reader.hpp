@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+// reads bit sequences written by a BitWriter from a stream
+class BitReader {
+private:
+    std::istream* m_stream;
+    uint8_t* m_buffer;
+    size_t m_bufsize;
+
+    size_t m_end;  // number of valid bytes in the buffer
+    size_t m_pos;  // current byte in the buffer
+    size_t m_bit;  // current bit in the current byte
+    bool m_eof;    // whether the buffer contains the end of the stream
+
+    inline void underflow() {
+        // keep the unread bytes
+        const size_t keep = m_end - m_pos;
+        std::memmove(m_buffer, m_buffer + m_pos, keep);
+        m_end = keep;
+        m_pos = 0;
+
+        m_stream->read((char*)m_buffer + m_end, m_bufsize - m_end);
+        m_end += m_stream->gcount();
+
+        // the stream may also end exactly where the buffer is full
+        m_eof = !*m_stream || m_stream->peek() == std::char_traits<char>::eof();
+    }
+
+public:
+    inline BitReader(std::istream& stream, const size_t bufsize = 8 * 1024 * 1024)
+        : m_stream(&stream), m_bufsize(bufsize), m_end(0), m_pos(0), m_bit(0), m_eof(false) {
+        m_buffer = new uint8_t[bufsize];
+        underflow();
+    }
+
+    BitReader(const BitReader&) = delete;
+    BitReader& operator=(const BitReader&) = delete;
+
+    inline ~BitReader() {
+        delete[] m_buffer;
+    }
+
+    // the number of bits left in the stream, but at most the given number
+    inline size_t available(const size_t max_bits) {
+        if(!m_eof && m_end - m_pos < max_bits / 8 + 2) underflow();
+
+        if(m_eof) {
+            // the last byte is the terminator
+            if(m_end - m_pos < 2) return 0;
+            const size_t valid_last = m_buffer[m_end - 1];
+            const size_t bits = (m_end - m_pos - 1) * 8 - m_bit - (8 - valid_last);
+            return bits < max_bits ? bits : max_bits;
+        } else {
+            return max_bits;
+        }
+    }
+
+    // reads the given number of bits (at most 64)
+    inline uint64_t read(size_t bits) {
+        if(!m_eof && m_end - m_pos < bits / 8 + 2) underflow();
+
+        uint64_t v = 0;
+        while(bits) {
+            const size_t take = (8 - m_bit) < bits ? (8 - m_bit) : bits;
+            const uint8_t x = uint8_t(m_buffer[m_pos] << m_bit) >> (8 - take);
+            v = (v << take) | x;
+            bits -= take;
+            m_bit += take;
+            if(m_bit == 8) {
+                m_bit = 0;
+                ++m_pos;
+            }
+        }
+        return v;
+    }
+};
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+
+// writes bit sequences to a stream through a buffer of 64-bit words, most significant bit first
+// the stream is terminated by a single byte that holds the number of valid bits in the byte before it (1 to 8)
+class BitWriter {
+private:
+    std::ostream* m_stream;
+    uint64_t* m_buffer;
+    size_t m_bufsize;
+    size_t m_cursor;
+
+    uint64_t m_word;
+    size_t m_free; // free bits in m_word
+
+    size_t m_bytes_written;
+    bool m_finished;
+
+    inline void flush_buffer(const size_t num_bytes) {
+        m_stream->write((const char*)m_buffer, num_bytes);
+        m_bytes_written += num_bytes;
+        m_cursor = 0;
+    }
+
+    inline void flush_word() {
+        m_buffer[m_cursor++] = __builtin_bswap64(m_word); // big endian, so bytes appear in bit order
+        if(m_cursor == m_bufsize) flush_buffer(m_bufsize * sizeof(uint64_t));
+        m_word = 0;
+        m_free = 64;
+    }
+
+public:
+    inline BitWriter(std::ostream& stream, const size_t bufsize = 1024 * 1024)
+        : m_stream(&stream), m_bufsize(bufsize), m_cursor(0), m_word(0), m_free(64), m_bytes_written(0), m_finished(false) {
+        m_buffer = new uint64_t[bufsize + 1]; // one extra word for finishing
+    }
+
+    BitWriter(const BitWriter&) = delete;
+    BitWriter& operator=(const BitWriter&) = delete;
+
+    inline ~BitWriter() {
+        finish();
+        delete[] m_buffer;
+    }
+
+    // writes the lowest bits of the value (at most 64)
+    inline void write(const uint64_t value, const size_t bits) {
+        if(bits == 0) return;
+
+        const uint64_t v = (bits < 64) ? (value & ((uint64_t(1) << bits) - 1)) : value;
+        if(bits < m_free) {
+            m_free -= bits;
+            m_word |= v << m_free;
+        } else {
+            const size_t rest = bits - m_free;
+            m_word |= v >> rest;
+            flush_word();
+            if(rest) {
+                m_free -= rest;
+                m_word = v << m_free;
+            }
+        }
+    }
+
+    // writes the remaining bits and the terminating byte
+    inline void finish() {
+        if(m_finished) return;
+        m_finished = true;
+
+        const size_t used = 64 - m_free;
+        const size_t num_bytes = (used + 7) / 8;
+        const uint8_t valid_bits = (used % 8) ? (used % 8) : 8;
+
+        // write the partial word byte by byte, followed by the terminator
+        auto* bytes = (uint8_t*)(m_buffer + m_cursor);
+        for(size_t i = 0; i < num_bytes; i++) bytes[i] = uint8_t(m_word >> (56 - 8 * i));
+        bytes[num_bytes] = (num_bytes > 0) ? valid_bits : 8;
+        flush_buffer(m_cursor * sizeof(uint64_t) + num_bytes + 1);
+        m_stream->flush();
+    }
+
+    // the number of bytes written to the stream so far
+    inline size_t bytes_written() const {
+        return m_bytes_written;
+    }
+};
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdlib>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// an append-only array that stores its items in fixed-size chunks of 2^chunk_bits items
+// growing allocates a new chunk, so items never move and nothing is ever copied
+template<typename item_t, size_t chunk_bits = 16>
+class ChunkedVector {
+    static_assert(std::is_trivially_copyable_v<item_t>);
+
+private:
+    static constexpr size_t CHUNK_SIZE = size_t(1) << chunk_bits;
+    static constexpr size_t CHUNK_MASK = CHUNK_SIZE - 1;
+
+    std::vector<item_t*> m_chunks;
+    size_t m_size;
+
+public:
+    inline ChunkedVector() : m_size(0) {
+    }
+
+    inline ChunkedVector(const ChunkedVector& other) : m_size(0) {
+        *this = other;
+    }
+
+    inline ChunkedVector(ChunkedVector&& other) : m_size(0) {
+        *this = std::move(other);
+    }
+
+    inline ~ChunkedVector() {
+        for(auto* chunk : m_chunks) std::free(chunk);
+    }
+
+    inline ChunkedVector& operator=(const ChunkedVector& other) {
+        if(this != &other) {
+            for(auto* chunk : m_chunks) std::free(chunk);
+            m_chunks.clear();
+            for(const auto* chunk : other.m_chunks) {
+                auto* copy = (item_t*)std::malloc(CHUNK_SIZE * sizeof(item_t));
+                std::copy(chunk, chunk + CHUNK_SIZE, copy);
+                m_chunks.emplace_back(copy);
+            }
+            m_size = other.m_size;
+        }
+        return *this;
+    }
+
+    inline ChunkedVector& operator=(ChunkedVector&& other) {
+        std::swap(m_chunks, other.m_chunks);
+        std::swap(m_size, other.m_size);
+        return *this;
+    }
+
+    inline item_t& operator[](const size_t i) {
+        return m_chunks[i >> chunk_bits][i & CHUNK_MASK];
+    }
+
+    inline const item_t& operator[](const size_t i) const {
+        return m_chunks[i >> chunk_bits][i & CHUNK_MASK];
+    }
+
+    inline void emplace_back(const item_t& item) {
+        if((m_size >> chunk_bits) == m_chunks.size()) {
+            m_chunks.emplace_back((item_t*)std::malloc(CHUNK_SIZE * sizeof(item_t)));
+        }
+        (*this)[m_size++] = item;
+    }
+
+    // removes all items, but keeps the chunks to be filled again
+    inline void clear() {
+        m_size = 0;
+    }
+
+    inline size_t size() const {
+        return m_size;
+    }
+
+    inline size_t size_bytes() const {
+        return m_chunks.size() * CHUNK_SIZE * sizeof(item_t) + m_chunks.capacity() * sizeof(item_t*);
+    }
+};
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+// a fast non-cryptographic 64-bit hash of a byte sequence, used to recognize changed inputs
+// the input is consumed in 8-byte words, each mixed in using a multiplication
+inline uint64_t hash_bytes(const void* data, const size_t size) {
+    constexpr uint64_t M = 0x9E3779B97F4A7C15ULL;
+    
+    const uint8_t* p = (const uint8_t*)data;
+    uint64_t h = size * M;
+    
+    size_t i = 0;
+    for(; i + 8 <= size; i += 8) {
+        uint64_t w;
+        std::memcpy(&w, p + i, 8);
+        h = (h ^ w) * M;
+        h ^= h >> 29;
+    }
+    if(i < size) {
+        uint64_t w = 0;
+        std::memcpy(&w, p + i, size - i);
+        h = (h ^ w) * M;
+        h ^= h >> 29;
+    }
+    
+    // finalize
+    h ^= h >> 32;
+    h *= M;
+    h ^= h >> 29;
+    return h;
+}
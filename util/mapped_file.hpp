@@ -0,0 +1,93 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <util/typedefs.hpp>
+
+// maps a file into memory read-only, exposing its contents as a span of characters without copying
+//
+// The mapping is always followed by at least one zero character, which can serve as the sentinel for suffix sorting.
+// To guarantee this even if the file size is a multiple of the page size, an address range one page larger than the
+// file is reserved (as anonymous zero pages) and the file is mapped over its beginning.
+class MappedFile {
+private:
+    const char_t* m_data;
+    size_t m_size;
+    size_t m_mapped_size;
+
+public:
+    enum Access {
+        SEQUENTIAL,
+        RANDOM
+    };
+
+    inline MappedFile(const std::string& filename, const Access access = SEQUENTIAL) : m_data(nullptr), m_size(0), m_mapped_size(0) {
+        const int fd = open(filename.c_str(), O_RDONLY);
+        if(fd < 0) {
+            std::cerr << "failed to open " << filename << std::endl;
+            return;
+        }
+
+        struct stat st;
+        if(fstat(fd, &st) != 0) {
+            std::cerr << "failed to stat " << filename << std::endl;
+            close(fd);
+            return;
+        }
+        const size_t size = st.st_size;
+
+        const size_t page_size = sysconf(_SC_PAGESIZE);
+        m_mapped_size = (size / page_size + 1) * page_size;
+
+        void* base = mmap(nullptr, m_mapped_size, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if(base == MAP_FAILED) {
+            std::cerr << "failed to reserve memory for " << filename << std::endl;
+            close(fd);
+            return;
+        }
+
+        if(size > 0 && mmap(base, size, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+            std::cerr << "failed to map " << filename << std::endl;
+            munmap(base, m_mapped_size);
+            close(fd);
+            return;
+        }
+        close(fd); // the mapping stays valid
+
+        // hints, failures are not critical
+        madvise(base, m_mapped_size, access == SEQUENTIAL ? MADV_SEQUENTIAL : MADV_RANDOM);
+#ifdef MADV_HUGEPAGE
+        madvise(base, m_mapped_size, MADV_HUGEPAGE);
+#endif
+
+        m_data = (const char_t*)base;
+        m_size = size;
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    inline ~MappedFile() {
+        if(m_data) munmap((void*)m_data, m_mapped_size);
+    }
+
+    // whether the file was mapped, otherwise the reason was printed and the size is zero
+    inline operator bool() const {
+        return m_data != nullptr;
+    }
+
+    inline const char_t* data() const {
+        return m_data;
+    }
+
+    // the size of the file, not including the trailing zero
+    inline size_t size() const {
+        return m_size;
+    }
+};
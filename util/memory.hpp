@@ -0,0 +1,33 @@
+#pragma once
+
+#include <fstream>
+#include <string>
+
+// queries the memory usage of the current process from /proc/self/status
+// returns zero if the information is not available
+inline size_t process_memory(const std::string& key) {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while(std::getline(status, line)) {
+        if(line.compare(0, key.size(), key) == 0 && line.size() > key.size() && line[key.size()] == ':') {
+            return std::stoull(line.substr(key.size() + 1)) * 1024; // reported in kB
+        }
+    }
+    return 0;
+}
+
+// the current resident set size in bytes
+inline size_t current_memory() {
+    return process_memory("VmRSS");
+}
+
+// the peak resident set size in bytes since the process started or since the last reset
+inline size_t peak_memory() {
+    return process_memory("VmHWM");
+}
+
+// resets the peak resident set size to the current one
+inline void reset_peak_memory() {
+    std::ofstream clear_refs("/proc/self/clear_refs");
+    clear_refs << "5";
+}
@@ -0,0 +1,198 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#include <util/typedefs.hpp>
+
+// a string over the DNA alphabet stored using two bits per character
+//
+// A, C, G and T are packed into 64-bit words, 32 characters each. All other characters (e.g., N or the sentinel) are
+// exceptions: they are packed like A and kept in a side list sorted by position. Every group of 256 characters has a
+// flag that tells whether it contains an exception, so that accessing a character only searches the side list if its
+// code is that of A and its group is flagged.
+//
+// Appending characters in bulk packs 32 characters at once using AVX2, if available.
+class PackedDNA {
+private:
+    static constexpr size_t GROUP_BITS = 8; // 256 characters per exception flag
+
+    std::vector<uint64_t> m_words;
+    std::vector<uint64_t> m_flags; // one bit per group
+    size_t m_size;
+
+    std::vector<uint64_t> m_exception_pos;
+    std::vector<char_t> m_exception_char;
+
+    // ACGT are distinguished by bits 1 and 2 of their ASCII codes: A=0, C=1, T=2, G=3
+    inline static uint64_t code(const char_t c) {
+        return ((uint8_t)c >> 1) & 3;
+    }
+
+    inline static bool is_dna(const char_t c) {
+        return c == 'A' || c == 'C' || c == 'G' || c == 'T';
+    }
+
+    inline void add_exception(const size_t i, const char_t c) {
+        m_exception_pos.emplace_back(i);
+        m_exception_char.emplace_back(c);
+
+        const size_t g = i >> GROUP_BITS;
+        if(g / 64 >= m_flags.size()) m_flags.resize(g / 64 + 1, 0);
+        m_flags[g / 64] |= uint64_t(1) << (g % 64);
+    }
+
+    inline bool flagged(const size_t i) const {
+        const size_t g = i >> GROUP_BITS;
+        return g / 64 < m_flags.size() && ((m_flags[g / 64] >> (g % 64)) & 1);
+    }
+
+#ifdef __AVX2__
+    // packs 32 characters into one word, returns false if any of them is an exception
+    inline static bool pack32(const char_t* chars, uint64_t& word) {
+        const __m256i v = _mm256_loadu_si256((const __m256i*)chars);
+
+        // check for exceptions
+        const __m256i dna = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('A')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('C'))),
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('G')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('T'))));
+        const bool ok = (uint32_t(_mm256_movemask_epi8(dna)) == 0xFFFFFFFFU);
+
+        // codes in the low two bits of each byte, non-DNA characters are packed as A
+        const __m256i codes = _mm256_and_si256(_mm256_and_si256(_mm256_srli_epi16(v, 1), _mm256_set1_epi8(3)), dna);
+
+        // combine adjacent codes: 8-bit lanes -> 4 bits per 16-bit lane -> 8 bits per 32-bit lane
+        const __m256i pairs = _mm256_maddubs_epi16(codes, _mm256_set1_epi16(0x0401));
+        const __m256i quads = _mm256_madd_epi16(pairs, _mm256_set1_epi32(0x00100001));
+
+        // gather the low byte of every 32-bit lane
+        const __m256i bytes = _mm256_shuffle_epi8(quads, _mm256_setr_epi8(
+            0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1));
+        const uint64_t lo = uint32_t(_mm256_extract_epi32(bytes, 0));
+        const uint64_t hi = uint32_t(_mm256_extract_epi32(bytes, 4));
+        word = lo | (hi << 32);
+        return ok;
+    }
+
+    // unpacks one word into 32 characters
+    inline static void unpack32(const uint64_t word, char_t* out) {
+        // byte k of the result holds the packed byte k/4
+        const __m256i bytes = _mm256_shuffle_epi8(_mm256_set1_epi64x(word), _mm256_setr_epi8(
+            0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3,
+            4, 4, 4, 4, 5, 5, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7));
+
+        // test the two bits of code k%4 in each byte
+        const __m256i bit0 = _mm256_setr_epi8(
+            1, 4, 16, 64, 1, 4, 16, 64, 1, 4, 16, 64, 1, 4, 16, 64,
+            1, 4, 16, 64, 1, 4, 16, 64, 1, 4, 16, 64, 1, 4, 16, 64);
+        const __m256i bit1 = _mm256_add_epi8(bit0, bit0);
+        const __m256i b0 = _mm256_cmpeq_epi8(_mm256_and_si256(bytes, bit0), bit0);
+        const __m256i b1 = _mm256_cmpeq_epi8(_mm256_and_si256(bytes, bit1), bit1);
+        const __m256i codes = _mm256_or_si256(_mm256_and_si256(b0, _mm256_set1_epi8(1)), _mm256_and_si256(b1, _mm256_set1_epi8(2)));
+
+        const __m256i chars = _mm256_shuffle_epi8(_mm256_setr_epi8(
+            'A', 'C', 'T', 'G', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+            'A', 'C', 'T', 'G', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0), codes);
+        _mm256_storeu_si256((__m256i*)out, chars);
+    }
+#endif
+
+public:
+    inline PackedDNA() : m_size(0) {
+    }
+
+    inline PackedDNA(const char_t* chars, const size_t n) : m_size(0) {
+        reserve(n);
+        append(chars, n);
+    }
+
+    inline void reserve(const size_t n) {
+        m_words.reserve(n / 32 + 1);
+        m_flags.reserve((n >> GROUP_BITS) / 64 + 1);
+    }
+
+    inline void push_back(const char_t c) {
+        if(m_size % 32 == 0) m_words.emplace_back(0);
+        if(is_dna(c)) {
+            m_words.back() |= code(c) << (2 * (m_size % 32));
+        } else {
+            add_exception(m_size, c);
+        }
+        ++m_size;
+    }
+
+    inline void append(const char_t* chars, const size_t num) {
+        size_t k = 0;
+
+        // fill the current word
+        while(k < num && m_size % 32 != 0) push_back(chars[k++]);
+
+#ifdef __AVX2__
+        // pack full words
+        for(; k + 32 <= num; k += 32) {
+            uint64_t word;
+            const bool ok = pack32(chars + k, word);
+            m_words.emplace_back(word);
+            if(!ok) {
+                for(size_t j = 0; j < 32; j++) {
+                    if(!is_dna(chars[k + j])) add_exception(m_size + j, chars[k + j]);
+                }
+            }
+            m_size += 32;
+        }
+#endif
+
+        while(k < num) push_back(chars[k++]);
+    }
+
+    inline char_t operator[](const size_t i) const {
+        const uint64_t c = (m_words[i / 32] >> (2 * (i % 32))) & 3;
+        if(c == 0 && flagged(i)) {
+            const auto it = std::lower_bound(m_exception_pos.begin(), m_exception_pos.end(), i);
+            if(it != m_exception_pos.end() && *it == i) return m_exception_char[it - m_exception_pos.begin()];
+        }
+        return "ACTG"[c];
+    }
+
+    // unpacks the characters [begin, begin + num) into out
+    inline void unpack(const size_t begin, const size_t num, char_t* out) const {
+        size_t k = 0;
+#ifdef __AVX2__
+        while(k < num && (begin + k) % 32 != 0) {
+            out[k] = (*this)[begin + k];
+            ++k;
+        }
+        for(; k + 32 <= num; k += 32) {
+            unpack32(m_words[(begin + k) / 32], out + k);
+        }
+        for(; k < num; k++) out[k] = (*this)[begin + k];
+
+        // patch exceptions
+        auto it = std::lower_bound(m_exception_pos.begin(), m_exception_pos.end(), begin);
+        for(; it != m_exception_pos.end() && *it < begin + num; ++it) {
+            out[*it - begin] = m_exception_char[it - m_exception_pos.begin()];
+        }
+#else
+        for(; k < num; k++) out[k] = (*this)[begin + k];
+#endif
+    }
+
+    inline size_t size() const {
+        return m_size;
+    }
+
+    inline size_t num_exceptions() const {
+        return m_exception_pos.size();
+    }
+
+    inline size_t size_bytes() const {
+        return m_words.capacity() * sizeof(uint64_t) + m_flags.capacity() * sizeof(uint64_t)
+            + m_exception_pos.capacity() * sizeof(uint64_t) + m_exception_char.capacity() * sizeof(char_t);
+    }
+};
@@ -0,0 +1,209 @@
+#pragma once
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// hardware performance counters of the calling process (including threads it starts), via perf_event_open
+//
+// Each event is opened on its own, so that events the CPU or kernel does not support are simply missing. If there are
+// more events than hardware counters, the kernel multiplexes them and the values are scaled by the fraction of time
+// they were actually counted. If no event can be opened at all (e.g., due to perf_event_paranoid or on other systems
+// than Linux), the counters are unavailable and all values are invalid.
+class PerfCounters {
+public:
+    enum Event {
+        CYCLES = 0,
+        INSTRUCTIONS,
+        BRANCH_MISSES,
+        L1D_MISSES,
+        LLC_MISSES,
+        DTLB_MISSES,
+        NUM_EVENTS
+    };
+
+    static constexpr const char* NAMES[NUM_EVENTS] = { "cycles", "instructions", "branch_misses", "l1d_misses", "llc_misses", "dtlb_misses" };
+
+    // event counts, summed over any number of measured regions
+    struct Values {
+        uint64_t count[NUM_EVENTS] = {};
+        bool valid[NUM_EVENTS] = {}; // whether the event was counted in every region
+        size_t regions = 0;
+
+        inline Values& operator+=(const Values& other) {
+            for(size_t e = 0; e < NUM_EVENTS; e++) {
+                count[e] += other.count[e];
+                valid[e] = (regions == 0 || valid[e]) && other.valid[e];
+            }
+            regions += other.regions;
+            return *this;
+        }
+
+        inline bool any() const {
+            for(size_t e = 0; e < NUM_EVENTS; e++) {
+                if(valid[e]) return true;
+            }
+            return false;
+        }
+
+        // the instructions per cycle and the events per character as key=value pairs
+        inline std::string to_string(const size_t chars) const {
+            std::string s;
+            if(valid[CYCLES] && valid[INSTRUCTIONS] && count[CYCLES] > 0) {
+                s += " ipc=" + std::to_string(double(count[INSTRUCTIONS]) / double(count[CYCLES]));
+            }
+            for(size_t e = 0; e < NUM_EVENTS; e++) {
+                if(valid[e]) s += " " + std::string(NAMES[e]) + "_per_char=" + std::to_string(chars ? double(count[e]) / double(chars) : 0.0);
+            }
+            return s;
+        }
+    };
+
+private:
+    int m_fd[NUM_EVENTS];
+    uint64_t m_base[NUM_EVENTS][3]; // value, time enabled and time running at the last reset
+    std::string m_error;
+
+#ifdef __linux__
+    inline static int open_event(const uint32_t type, const uint64_t config) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.inherit = 1; // also count threads started while enabled
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        return int(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+
+    inline static uint64_t cache_miss(const uint64_t cache) {
+        return cache | (uint64_t(PERF_COUNT_HW_CACHE_OP_READ) << 8) | (uint64_t(PERF_COUNT_HW_CACHE_RESULT_MISS) << 16);
+    }
+
+    inline void ioctl_all(const unsigned long request) {
+        for(size_t e = 0; e < NUM_EVENTS; e++) {
+            if(m_fd[e] >= 0) ioctl(m_fd[e], request, 0);
+        }
+    }
+
+    inline bool read_raw(const size_t e, uint64_t* buf) const {
+        return m_fd[e] >= 0 && ::read(m_fd[e], buf, 3 * sizeof(uint64_t)) == 3 * sizeof(uint64_t);
+    }
+#endif
+
+public:
+    inline PerfCounters() {
+        for(size_t e = 0; e < NUM_EVENTS; e++) m_fd[e] = -1;
+        std::memset(m_base, 0, sizeof(m_base));
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    inline ~PerfCounters() {
+        close();
+    }
+
+    // opens the counters, returns whether at least one is available
+    inline bool open() {
+        close();
+#ifdef __linux__
+        m_fd[CYCLES] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+        m_fd[INSTRUCTIONS] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+        m_fd[BRANCH_MISSES] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+        m_fd[L1D_MISSES] = open_event(PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_L1D));
+        m_fd[LLC_MISSES] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+        m_fd[DTLB_MISSES] = open_event(PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_DTLB));
+
+        if(!available()) m_error = std::string("perf_event_open: ") + std::strerror(errno);
+#else
+        m_error = "not supported on this system";
+#endif
+        return available();
+    }
+
+    inline void close() {
+#ifdef __linux__
+        for(size_t e = 0; e < NUM_EVENTS; e++) {
+            if(m_fd[e] >= 0) ::close(m_fd[e]);
+            m_fd[e] = -1;
+        }
+#endif
+    }
+
+    inline bool available() const {
+        for(size_t e = 0; e < NUM_EVENTS; e++) {
+            if(m_fd[e] >= 0) return true;
+        }
+        return false;
+    }
+
+    // the reason why no counter is available
+    inline const std::string& error() const {
+        return m_error;
+    }
+
+    // sets all counts to zero
+    // the kernel does not reset the enabled and running times, so the current values serve as the new baseline
+    inline void reset() {
+#ifdef __linux__
+        for(size_t e = 0; e < NUM_EVENTS; e++) {
+            if(!read_raw(e, m_base[e])) std::memset(m_base[e], 0, sizeof(m_base[e]));
+        }
+#endif
+    }
+
+    // starts counting from zero
+    inline void start() {
+        reset();
+#ifdef __linux__
+        ioctl_all(PERF_EVENT_IOC_ENABLE);
+#endif
+    }
+
+    // stops counting
+    inline void stop() {
+#ifdef __linux__
+        ioctl_all(PERF_EVENT_IOC_DISABLE);
+#endif
+    }
+
+    // continues counting after stop without resetting the counts
+    inline void resume() {
+#ifdef __linux__
+        ioctl_all(PERF_EVENT_IOC_ENABLE);
+#endif
+    }
+
+    // the counts since the last start or reset
+    inline Values read() const {
+        Values values;
+        values.regions = 1;
+#ifdef __linux__
+        for(size_t e = 0; e < NUM_EVENTS; e++) {
+            uint64_t buf[3];
+            if(!read_raw(e, buf)) continue;
+
+            const uint64_t value = buf[0] - m_base[e][0];
+            const uint64_t enabled = buf[1] - m_base[e][1];
+            const uint64_t running = buf[2] - m_base[e][2];
+            if(enabled > 0 && running == 0) continue; // never scheduled
+
+            values.valid[e] = true;
+            values.count[e] = (running > 0 && running < enabled) ? uint64_t(double(value) * double(enabled) / double(running)) : value;
+        }
+#endif
+        return values;
+    }
+};
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <vector>
+
+// a static bit vector that supports rank queries in constant time
+//
+// The bits are stored in cache line sized blocks of seven 64-bit words, preceded by the number of set bits before the
+// block, so that a query touches a single cache line.
+class RankBitVector {
+private:
+    static constexpr size_t DATA_WORDS = 7;
+    static constexpr size_t DATA_BITS = 64 * DATA_WORDS;
+
+    struct alignas(64) Block {
+        uint64_t rank;
+        uint64_t words[DATA_WORDS];
+    };
+
+    std::vector<Block> m_blocks;
+    size_t m_size;
+
+public:
+    inline RankBitVector() : m_size(0) {
+    }
+
+    inline RankBitVector(const size_t size) : m_blocks(size / DATA_BITS + 1, Block {}), m_size(size) {
+    }
+
+    inline void set(const size_t i) {
+        m_blocks[i / DATA_BITS].words[(i % DATA_BITS) / 64] |= uint64_t(1) << (i % 64);
+    }
+
+    inline bool operator[](const size_t i) const {
+        return (m_blocks[i / DATA_BITS].words[(i % DATA_BITS) / 64] >> (i % 64)) & 1;
+    }
+
+    // computes the block ranks, must be called after all bits have been set and before rank is used
+    inline void build() {
+        uint64_t rank = 0;
+        for(auto& block : m_blocks) {
+            block.rank = rank;
+            for(size_t w = 0; w < DATA_WORDS; w++) rank += std::popcount(block.words[w]);
+        }
+    }
+
+    // the number of set bits in [0, i)
+    inline size_t rank1(const size_t i) const {
+        const auto& block = m_blocks[i / DATA_BITS];
+        const size_t bit = i % DATA_BITS;
+        const size_t w = bit / 64;
+
+        size_t rank = block.rank;
+        for(size_t k = 0; k < w; k++) rank += std::popcount(block.words[k]);
+        if(bit % 64) rank += std::popcount(block.words[w] << (64 - bit % 64));
+        return rank;
+    }
+
+    inline size_t size() const {
+        return m_size;
+    }
+
+    inline size_t size_bytes() const {
+        return m_blocks.capacity() * sizeof(Block);
+    }
+};
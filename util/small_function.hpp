@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+template<typename Signature>
+class SmallFunction;
+
+// a type-erased callable that stores the callable in an internal buffer instead of on the heap, like std::function
+// with its small buffer optimization, but without a heap fallback
+//
+// Only trivially copyable callables that fit into the buffer are supported (e.g., lambdas capturing up to two
+// pointers), so copying is a plain copy of the buffer and there is nothing to destroy. Invoking costs one indirect
+// call through the stored invoker.
+template<typename R, typename... Args>
+class SmallFunction<R(Args...)> {
+private:
+    static constexpr size_t BUFFER_SIZE = 2 * sizeof(void*);
+
+    alignas(std::max_align_t) unsigned char m_buffer[BUFFER_SIZE];
+    R (*m_invoke)(const void*, Args...);
+
+public:
+    inline SmallFunction() : m_invoke(nullptr) {
+    }
+
+    template<typename F>
+    inline SmallFunction(F f) {
+        static_assert(sizeof(F) <= BUFFER_SIZE, "callable too large for SmallFunction");
+        static_assert(std::is_trivially_copyable_v<F>, "SmallFunction only supports trivially copyable callables");
+
+        new(m_buffer) F(f);
+        m_invoke = [](const void* buffer, Args... args) -> R {
+            return (*(const F*)buffer)(std::forward<Args>(args)...);
+        };
+    }
+
+    inline R operator()(Args... args) const {
+        return m_invoke(m_buffer, std::forward<Args>(args)...);
+    }
+
+    inline explicit operator bool() const {
+        return m_invoke != nullptr;
+    }
+};
@@ -8,3 +8,11 @@ inline uint64_t time() {
     return uint64_t(duration_cast<milliseconds>(
         high_resolution_clock::now().time_since_epoch()).count());
 }
+
+// a monotonic timestamp in nanoseconds, for measurements
+inline uint64_t time_ns() {
+    using namespace std::chrono;
+    
+    return uint64_t(duration_cast<nanoseconds>(
+        steady_clock::now().time_since_epoch()).count());
+}
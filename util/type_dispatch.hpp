@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <initializer_list>
+#include <string_view>
+#include <type_traits>
+
+// a list of types to choose from at runtime
+template<typename... Ts>
+struct TypeList {
+    static constexpr size_t size = sizeof...(Ts);
+};
+
+// calls f(std::type_identity<T>{}) for the index-th type T of the list, returns false if the index is out of range
+//
+// This turns a runtime choice into a template instantiation: f is instantiated for every type of the list, and the
+// choice is made once by comparing the index, so that everything f does with T is resolved at compile time.
+template<typename... Ts, typename F>
+inline bool dispatch(TypeList<Ts...>, const size_t index, F&& f) {
+    size_t i = 0;
+    return ((i++ == index && (f(std::type_identity<Ts>{}), true)) || ...);
+}
+
+// calls f(std::type_identity<T>{}, std::type_identity<U>{}) for the i-th type T of the first and the j-th type U of
+// the second list, returns false if either index is out of range
+template<typename... Ts, typename... Us, typename F>
+inline bool dispatch(TypeList<Ts...> ts, const size_t i, TypeList<Us...> us, const size_t j, F&& f) {
+    if(j >= sizeof...(Us)) return false;
+    return dispatch(ts, i, [&](auto t){
+        dispatch(us, j, [&](auto u){ f(t, u); });
+    });
+}
+
+// the position of a name in a list of names, or the number of names if it is not contained
+inline size_t index_of(const std::initializer_list<std::string_view> names, const std::string_view name) {
+    size_t i = 0;
+    for(const auto& x : names) {
+        if(x == name) break;
+        ++i;
+    }
+    return i;
+}
@@ -2,5 +2,6 @@
 
 #include <cstdint>
 
+#include <util/uint40.hpp>
+
 using char_t = char;
-using index_t = uint32_t;
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+
+// a packed 40-bit unsigned integer, which can address 1 TiB of text while using only five bytes of memory
+//
+// It converts implicitly from and to uint64_t, so it can be used as an index type wherever arithmetic is done on
+// the converted value and the result is stored back.
+class __attribute__((packed)) uint40_t {
+private:
+    uint32_t m_low;
+    uint8_t m_high;
+
+public:
+    inline constexpr uint40_t() : m_low(0), m_high(0) {
+    }
+
+    inline constexpr uint40_t(const uint64_t x) : m_low(uint32_t(x)), m_high(uint8_t(x >> 32)) {
+    }
+
+    inline constexpr operator uint64_t() const {
+        return uint64_t(m_low) | (uint64_t(m_high) << 32);
+    }
+};
+
+static_assert(sizeof(uint40_t) == 5);
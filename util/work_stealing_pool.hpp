@@ -0,0 +1,101 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// runs jobs on a fixed number of threads with work stealing
+//
+// The jobs are dealt out round-robin to one queue per thread in the order they are given, e.g., by decreasing size.
+// Each thread takes jobs from the front of its own queue. Once it runs empty, it steals from the back of the fullest
+// queue of another thread, so threads that got shorter jobs help out the others instead of idling at the end.
+class WorkStealingPool {
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<size_t> jobs;
+    };
+
+    size_t m_num_threads;
+    std::atomic<size_t> m_steals;
+
+    inline static bool pop_front(Queue& q, size_t& job) {
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if(q.jobs.empty()) return false;
+        job = q.jobs.front();
+        q.jobs.pop_front();
+        return true;
+    }
+
+    inline static bool pop_back(Queue& q, size_t& job) {
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if(q.jobs.empty()) return false;
+        job = q.jobs.back();
+        q.jobs.pop_back();
+        return true;
+    }
+
+public:
+    inline WorkStealingPool(const size_t num_threads) : m_num_threads(std::max(num_threads, size_t(1))), m_steals(0) {
+    }
+
+    inline size_t num_threads() const {
+        return m_num_threads;
+    }
+
+    // the number of jobs that were stolen during the last run
+    inline size_t steals() const {
+        return m_steals.load();
+    }
+
+    // calls f(thread, job) for every job in [0, num_jobs) and returns after all of them are done
+    // thread is the number of the calling thread in [0, num_threads), e.g., to use per-thread resources
+    template<typename job_t>
+    inline void run(const size_t num_jobs, job_t f) {
+        std::vector<std::unique_ptr<Queue>> queues(m_num_threads);
+        for(auto& q : queues) q = std::make_unique<Queue>();
+        for(size_t j = 0; j < num_jobs; j++) {
+            queues[j % m_num_threads]->jobs.emplace_back(j);
+        }
+        m_steals = 0;
+
+        auto worker = [&](const size_t t){
+            size_t job;
+            while(true) {
+                if(pop_front(*queues[t], job)) {
+                    f(t, job);
+                    continue;
+                }
+
+                // steal from the thread with the most remaining jobs
+                size_t victim = t;
+                size_t max_jobs = 0;
+                for(size_t v = 0; v < m_num_threads; v++) {
+                    if(v == t) continue;
+                    std::lock_guard<std::mutex> lock(queues[v]->mutex);
+                    if(queues[v]->jobs.size() > max_jobs) {
+                        max_jobs = queues[v]->jobs.size();
+                        victim = v;
+                    }
+                }
+                if(victim == t) break; // all queues are empty, and jobs are never added during a run
+
+                if(pop_back(*queues[victim], job)) {
+                    ++m_steals;
+                    f(t, job);
+                }
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for(size_t t = 1; t < m_num_threads; t++) {
+            threads.emplace_back(worker, t);
+        }
+        worker(0);
+        for(auto& thread : threads) thread.join();
+    }
+};